@@ -0,0 +1,364 @@
+// Offline batch analytics over a cricket_stats.dat file (or a copy of one).
+// Recomputes every player's statistics and the season, role, opponent and
+// venue reports from the full match history, using all cores, and writes
+// them as JSON or CSV. Runs without the API server.
+//
+// Usage: cricket_batch [data file] [output dir] [--threads=N] [--format=json|csv]
+#include <thread>
+#include <chrono>
+#include <cmath>
+
+#include "cricket_stats.h"
+
+// Statistics for one player, recomputed from the match history
+struct PlayerReport {
+    int id;
+    string name;
+    string role;
+    int matches;
+    long long runs;
+    int best;
+    double average;
+    double homeAverage;
+    double awayAverage;
+    double recentAverage;
+    double standardDeviation;
+    bool inForm;
+    int fifties;
+    int hundreds;
+    int ducks;
+};
+
+// Running totals for one season, role, opponent or venue
+struct GroupTotals {
+    long long innings = 0;
+    long long runs = 0;
+    int best = 0;
+    int fifties = 0;
+    int hundreds = 0;
+    
+    void add(int score) {
+        best = innings == 0 ? score : max(best, score);
+        innings++;
+        runs += score;
+        if (score >= 100) hundreds++;
+        else if (score >= 50) fifties++;
+    }
+    
+    void merge(const GroupTotals& other) {
+        if (other.innings == 0) return;
+        best = innings == 0 ? other.best : max(best, other.best);
+        innings += other.innings;
+        runs += other.runs;
+        fifties += other.fifties;
+        hundreds += other.hundreds;
+    }
+};
+
+// What one worker produces for its share of the players
+struct WorkerResult {
+    bool ok = true;
+    vector<PlayerReport> players;
+    map<string, GroupTotals> seasons;
+    map<string, GroupTotals> roles;
+    map<string, GroupTotals> opponents;
+    map<string, GroupTotals> venues;
+};
+
+PlayerReport buildPlayerReport(const Player& player, const vector<MatchStats>& stats) {
+    PlayerReport report;
+    report.id = player.getId();
+    report.name = player.getName();
+    report.role = player.getRole();
+    report.matches = static_cast<int>(stats.size());
+    report.runs = 0;
+    report.best = 0;
+    report.fifties = report.hundreds = report.ducks = 0;
+    
+    long long homeRuns = 0;
+    int homeMatches = 0;
+    double squares = 0.0;
+    for (const auto& match : stats) {
+        report.runs += match.score;
+        report.best = max(report.best, match.score);
+        squares += static_cast<double>(match.score) * match.score;
+        if (match.isHome) {
+            homeRuns += match.score;
+            homeMatches++;
+        }
+        if (match.score >= 100) report.hundreds++;
+        else if (match.score >= 50) report.fifties++;
+        else if (match.score == 0) report.ducks++;
+    }
+    
+    int awayMatches = report.matches - homeMatches;
+    report.average = report.matches > 0 ? static_cast<double>(report.runs) / report.matches : 0.0;
+    report.homeAverage = homeMatches > 0 ? static_cast<double>(homeRuns) / homeMatches : 0.0;
+    report.awayAverage = awayMatches > 0 ? static_cast<double>(report.runs - homeRuns) / awayMatches : 0.0;
+    report.standardDeviation = report.matches > 0 
+        ? sqrt(max(0.0, squares / report.matches - report.average * report.average)) : 0.0;
+    
+    // Same rules as Player::isInForm and getRecentPerformance
+    size_t recentCount = min<size_t>(stats.size(), RECENT_SCORES_KEPT);
+    double recentRuns = 0.0;
+    for (size_t i = stats.size() - recentCount; i < stats.size(); i++) {
+        recentRuns += stats[i].score;
+    }
+    report.recentAverage = recentCount > 0 ? recentRuns / recentCount : 0.0;
+    
+    report.inForm = false;
+    if (stats.size() >= 3) {
+        double lastThree = 0.0;
+        for (size_t i = stats.size() - 3; i < stats.size(); i++) {
+            lastThree += stats[i].score;
+        }
+        report.inForm = lastThree / 3 > report.average;
+    }
+    return report;
+}
+
+// Fold players[begin, end) into result, reading their history from file.
+// The history is parsed into a local vector rather than through the Player,
+// whose history cache is shared by every worker.
+void reportRange(istream& file, const vector<Player*>& players, size_t begin, size_t end,
+                 WorkerResult& result) {
+    vector<MatchStats> stats;
+    for (size_t i = begin; i < end; i++) {
+        const Player* player = players[i];
+        stats.assign(player->getTotalMatches(), MatchStats());
+        file.clear();
+        file.seekg(player->getStatsOffset());
+        for (auto& match : stats) {
+            match.deserialize(file);
+        }
+        
+        result.players.push_back(buildPlayerReport(*player, stats));
+        GroupTotals& role = result.roles[player->getRole()];
+        for (const auto& match : stats) {
+            result.seasons[match.date.substr(0, 4)].add(match.score);
+            result.opponents[match.opponent].add(match.score);
+            result.venues[match.venue].add(match.score);
+            role.add(match.score);
+        }
+    }
+}
+
+// Parse and report on players[begin, end) using a private file handle, so
+// workers read different parts of the file in parallel
+void runWorker(const string& filename, const vector<Player*>& players, size_t begin, size_t end,
+               WorkerResult& result) {
+    ifstream file(filename, ios::binary);
+    if (!file.is_open()) {
+        cerr << "Error: Could not open " << filename << endl;
+        result.ok = false;
+        return;
+    }
+    
+    try {
+        reportRange(file, players, begin, end, result);
+    } catch (const exception& e) {
+        cerr << "Error: Could not read " << filename << ": " << e.what() << endl;
+        result.ok = false;
+    }
+}
+
+// Report writers return false if the file could not be written completely
+bool finishReport(ofstream& out, const string& path) {
+    out.close();
+    if (out.fail()) {
+        cerr << "Error: Could not write " << path << endl;
+        return false;
+    }
+    return true;
+}
+
+bool writePlayers(const string& path, const vector<PlayerReport>& players, bool csv) {
+    ofstream out(path, ios::binary);
+    if (!out.is_open()) {
+        cerr << "Error: Could not write " << path << endl;
+        return false;
+    }
+    
+    if (csv) {
+        out << "id,name,role,matches,runs,best,average,homeAverage,awayAverage,"
+            << "recentAverage,standardDeviation,inForm,fifties,hundreds,ducks\n";
+        out << fixed << setprecision(2);
+        for (const auto& p : players) {
+            out << p.id << "," << csvField(p.name) << "," << csvField(p.role) << "," << p.matches << "," << p.runs << ","
+                << p.best << "," << p.average << "," << p.homeAverage << "," << p.awayAverage << ","
+                << p.recentAverage << "," << p.standardDeviation << "," << (p.inForm ? "true" : "false")
+                << "," << p.fifties << "," << p.hundreds << "," << p.ducks << "\n";
+        }
+        return finishReport(out, path);
+    }
+    
+    out << "[";
+    for (size_t i = 0; i < players.size(); i++) {
+        const PlayerReport& p = players[i];
+        JsonBuilder row;
+        row.addNumber("id", p.id);
+        row.addString("name", p.name);
+        row.addString("role", p.role);
+        row.addNumber("matches", p.matches);
+        row.addNumber("runs", p.runs);
+        row.addNumber("bestScore", p.best);
+        row.addDouble("average", p.average);
+        row.addDouble("homeAverage", p.homeAverage);
+        row.addDouble("awayAverage", p.awayAverage);
+        row.addDouble("recentAverage", p.recentAverage);
+        row.addDouble("standardDeviation", p.standardDeviation);
+        row.addBool("inForm", p.inForm);
+        row.addNumber("fifties", p.fifties);
+        row.addNumber("hundreds", p.hundreds);
+        row.addNumber("ducks", p.ducks);
+        out << (i > 0 ? ",\n" : "\n") << row.build();
+    }
+    out << "\n]\n";
+    return finishReport(out, path);
+}
+
+bool writeGroups(const string& path, const string& key, const map<string, GroupTotals>& groups, bool csv) {
+    ofstream out(path, ios::binary);
+    if (!out.is_open()) {
+        cerr << "Error: Could not write " << path << endl;
+        return false;
+    }
+    
+    if (csv) {
+        out << key << ",innings,runs,average,best,fifties,hundreds\n";
+        out << fixed << setprecision(2);
+        for (const auto& pair : groups) {
+            const GroupTotals& g = pair.second;
+            out << csvField(pair.first) << "," << g.innings << "," << g.runs << ","
+                << static_cast<double>(g.runs) / g.innings << "," << g.best << ","
+                << g.fifties << "," << g.hundreds << "\n";
+        }
+        return finishReport(out, path);
+    }
+    
+    out << "[";
+    bool first = true;
+    for (const auto& pair : groups) {
+        const GroupTotals& g = pair.second;
+        JsonBuilder row;
+        row.addString(key, pair.first);
+        row.addNumber("innings", g.innings);
+        row.addNumber("runs", g.runs);
+        row.addDouble("average", static_cast<double>(g.runs) / g.innings);
+        row.addNumber("bestScore", g.best);
+        row.addNumber("fifties", g.fifties);
+        row.addNumber("hundreds", g.hundreds);
+        out << (first ? "\n" : ",\n") << row.build();
+        first = false;
+    }
+    out << "\n]\n";
+    return finishReport(out, path);
+}
+
+int main(int argc, char* argv[]) {
+    string dataFile = DATA_FILE;
+    string outputDir = ".";
+    unsigned threadCount = max(1u, thread::hardware_concurrency());
+    string format = "json";
+    
+    int positional = 0;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg.find("--threads=") == 0) {
+            threadCount = max(1, stoi(arg.substr(10)));
+        } else if (arg.find("--format=") == 0) {
+            format = arg.substr(9);
+        } else if (positional == 0) {
+            dataFile = arg;
+            positional++;
+        } else {
+            outputDir = arg;
+            positional++;
+        }
+    }
+    if (format != "json" && format != "csv") {
+        cerr << "Unsupported format: " << format << " (use json or csv)" << endl;
+        return 1;
+    }
+    
+    auto startTime = chrono::steady_clock::now();
+    
+    // loadFromFile treats a missing file as an empty list, which is not a
+    // useful result for a batch job
+    if (!ifstream(dataFile, ios::binary).is_open()) {
+        cerr << "Error: Could not open " << dataFile << endl;
+        return 1;
+    }
+    
+    // Headers only, without aggregates: older files would otherwise be
+    // parsed here once and again by the workers, each of which parses its
+    // own byte range of the history
+    PlayerList playerList;
+    try {
+        playerList.loadFromFile(dataFile, false);
+    } catch (const exception& e) {
+        cerr << "Error: Could not read " << dataFile << ": " << e.what() << endl;
+        return 1;
+    }
+    vector<Player*> players;
+    long long totalBytes = 0;
+    for (Player* current = playerList.getHead(); current != nullptr; current = current->getNext()) {
+        players.push_back(current);
+        totalBytes += current->getStatsBytes();
+    }
+    
+    // Split the players into contiguous ranges holding similar amounts of data
+    vector<size_t> bounds(1, 0);
+    long long accumulated = 0;
+    for (size_t i = 0; i < players.size(); i++) {
+        accumulated += players[i]->getStatsBytes();
+        if (bounds.size() < threadCount && accumulated * threadCount >= totalBytes * (long long)bounds.size()) {
+            bounds.push_back(i + 1);
+        }
+    }
+    if (bounds.back() != players.size()) {
+        bounds.push_back(players.size());
+    }
+    
+    size_t workerCount = bounds.size() - 1;
+    vector<WorkerResult> results(workerCount);
+    vector<thread> workers;
+    for (size_t w = 0; w < workerCount; w++) {
+        workers.emplace_back(runWorker, cref(dataFile), cref(players), bounds[w], bounds[w + 1], ref(results[w]));
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    
+    // Ranges are contiguous, so concatenating keeps file order
+    WorkerResult total;
+    long long innings = 0;
+    for (auto& result : results) {
+        if (!result.ok) return 1;
+        total.players.insert(total.players.end(), result.players.begin(), result.players.end());
+        for (const auto& pair : result.seasons) total.seasons[pair.first].merge(pair.second);
+        for (const auto& pair : result.roles) total.roles[pair.first].merge(pair.second);
+        for (const auto& pair : result.opponents) total.opponents[pair.first].merge(pair.second);
+        for (const auto& pair : result.venues) total.venues[pair.first].merge(pair.second);
+    }
+    for (const auto& report : total.players) {
+        innings += report.matches;
+    }
+    
+    bool csv = format == "csv";
+    string prefix = outputDir + "/";
+    bool written = writePlayers(prefix + "players_report." + format, total.players, csv);
+    written = writeGroups(prefix + "seasons_report." + format, "season", total.seasons, csv) && written;
+    written = writeGroups(prefix + "roles_report." + format, "role", total.roles, csv) && written;
+    written = writeGroups(prefix + "opponents_report." + format, "opponent", total.opponents, csv) && written;
+    written = writeGroups(prefix + "venues_report." + format, "venue", total.venues, csv) && written;
+    if (!written) {
+        return 1;
+    }
+    
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+    cout << "Processed " << players.size() << " players and " << innings << " innings with "
+         << workerCount << " threads in " << fixed << setprecision(2) << seconds << "s" << endl;
+    cout << "Reports written to " << outputDir << endl;
+    return 0;
+}
@@ -0,0 +1,984 @@
+// Cricket statistics data model: match records, players with their
+// aggregates, lazily loaded match history and the player list.
+// Shared by the API server and the offline batch tool.
+#ifndef CRICKET_STATS_H
+#define CRICKET_STATS_H
+
+#include <iostream>
+#include <string>
+#include <sstream>
+#include <map>
+#include <vector>
+#include <fstream>
+#include <algorithm>
+#include <iomanip>
+#include <numeric>
+#include <list>
+#include <unordered_map>
+#include <cstdio>
+#include <limits>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+using namespace std;
+
+// Constants
+const int MAX_NAME_LENGTH = 50;
+const int MAX_DATE_LENGTH = 20;
+const int MIN_SCORE = 0;
+const int MAX_SCORE = 1000;
+const string DATA_FILE = "cricket_stats.dat";
+const size_t DEFAULT_HISTORY_BUDGET = 64 * 1024 * 1024;
+const int RECENT_SCORES_KEPT = 5;
+// Written after the player count on the first line of the data file. Files
+// from older versions load through a full scan of the match history.
+const int DATA_FORMAT_VERSION = 2;
+
+// MatchStats structure
+struct MatchStats {
+    string date;
+    int score;
+    string opponent;
+    string venue;
+    bool isHome;
+    
+    MatchStats(string d = "", int s = 0, string opp = "", string v = "", bool home = true) 
+        : date(d), score(s), opponent(opp), venue(v), isHome(home) {}
+    
+    // For file I/O
+    void serialize(ostream& file) const {
+        file << date << "|" << score << "|" << opponent << "|" << venue << "|" << isHome << "\n";
+    }
+    
+    void deserialize(istream& file) {
+        string line;
+        if (getline(file, line)) {
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            stringstream ss(line);
+            getline(ss, date, '|');
+            string scoreStr;
+            getline(ss, scoreStr, '|');
+            score = stoi(scoreStr);
+            getline(ss, opponent, '|');
+            getline(ss, venue, '|');
+            string homeStr;
+            getline(ss, homeStr, '|');
+            isHome = (homeStr == "1");
+        }
+    }
+    
+    // Approximate heap footprint, used for the history memory budget
+    size_t memoryUsage() const {
+        return sizeof(MatchStats) + date.size() + opponent.size() + venue.size();
+    }
+};
+
+class MatchHistoryStore;
+
+// Runs scored against one opponent, part of the player aggregates
+struct OpponentTotal {
+    string opponent;
+    long long total;
+    int count;
+};
+
+// Player class
+class Player {
+private:
+    string name;
+    string role;
+    mutable vector<MatchStats> stats;
+    Player* next;
+    int playerId;
+    
+    // Aggregates maintained by addMatch, so statistics never need the history
+    int matchCount;
+    long long totalScore;
+    int bestScore;
+    long long homeTotal;
+    int homeCount;
+    vector<int> recentScores;
+    // One entry per opponent faced; a player meets few distinct teams, so a
+    // vector with linear lookup is smaller than a map
+    vector<OpponentTotal> opponentTotals;
+    
+    // Match history is paged in from the data file on demand
+    MatchHistoryStore* history;
+    mutable bool statsLoaded;
+    mutable size_t statsMemory;
+    bool dirty;
+    long long statsOffset;
+    long long statsBytes;
+    
+    // Last ID handed out; a function-local static so the header can be
+    // included from more than one source file
+    static int& nextId() {
+        static int lastId = 0;
+        return lastId;
+    }
+    
+    void ensureStatsLoaded() const;
+    void notifyHistory() const;
+    
+    void addToAggregates(const MatchStats& match) {
+        bestScore = matchCount == 0 ? match.score : max(bestScore, match.score);
+        matchCount++;
+        totalScore += match.score;
+        if (match.isHome) {
+            homeTotal += match.score;
+            homeCount++;
+        }
+        recentScores.push_back(match.score);
+        if ((int)recentScores.size() > RECENT_SCORES_KEPT) {
+            recentScores.erase(recentScores.begin());
+        }
+        OpponentTotal* opponent = findOpponent(match.opponent);
+        if (opponent == nullptr) {
+            OpponentTotal added = {match.opponent, 0, 0};
+            opponentTotals.push_back(added);
+            opponent = &opponentTotals.back();
+        }
+        opponent->total += match.score;
+        opponent->count++;
+    }
+    
+    OpponentTotal* findOpponent(const string& opponent) {
+        for (auto& entry : opponentTotals) {
+            if (entry.opponent == opponent) return &entry;
+        }
+        return nullptr;
+    }
+    
+    // Opponent names are free text; escape the characters that delimit the
+    // opponents header field
+    static string escapeOpponent(const string& name) {
+        string escaped;
+        for (char c : name) {
+            if (c == '%' || c == ',' || c == '=' || c == '|' || c == '\n' || c == '\r') {
+                char code[4];
+                snprintf(code, sizeof(code), "%%%02X", static_cast<unsigned char>(c));
+                escaped += code;
+            } else {
+                escaped += c;
+            }
+        }
+        return escaped;
+    }
+    
+    static string unescapeOpponent(const string& escaped) {
+        string name;
+        for (size_t i = 0; i < escaped.size(); i++) {
+            if (escaped[i] == '%' && i + 2 < escaped.size()) {
+                name += static_cast<char>(stoi(escaped.substr(i + 1, 2), nullptr, 16));
+                i += 2;
+            } else {
+                name += escaped[i];
+            }
+        }
+        return name;
+    }
+    
+    void resetAggregates() {
+        matchCount = 0;
+        totalScore = homeTotal = 0;
+        bestScore = homeCount = 0;
+        recentScores.clear();
+        opponentTotals.clear();
+    }
+    
+public:
+    Player(string n = "", string r = "") 
+        : name(n), role(r), next(nullptr), matchCount(0), totalScore(0), bestScore(0), 
+          homeTotal(0), homeCount(0), history(nullptr), statsLoaded(true), statsMemory(0), 
+          dirty(false), statsOffset(-1), statsBytes(0) {
+        playerId = ++nextId();
+        resetAggregates();
+    }
+    
+    // PlayerList owns and deletes the nodes, so next is not deleted here
+    ~Player();
+    
+    // Getters
+    string getName() const { return name; }
+    string getRole() const { return role; }
+    const vector<MatchStats>& getStats() const {
+        ensureStatsLoaded();
+        return stats;
+    }
+    Player* getNext() const { return next; }
+    int getId() const { return playerId; }
+    
+    // Setters
+    void setNext(Player* next) { this->next = next; }
+    void setName(string n) { name = n; }
+    void setRole(string r) { role = r; }
+    void attachHistory(MatchHistoryStore* store) { history = store; }
+    
+    // Add match statistics
+    void addMatch(const MatchStats& match) {
+        ensureStatsLoaded();
+        stats.push_back(match);
+        statsMemory += match.memoryUsage();
+        addToAggregates(match);
+        dirty = true;
+        notifyHistory();
+    }
+    
+    // Advanced statistics methods
+    int getBestScore() const {
+        return bestScore;
+    }
+    
+    double getAverageScore() const {
+        if (matchCount == 0) return 0.0;
+        return static_cast<double>(totalScore) / matchCount;
+    }
+    
+    int getTotalMatches() const {
+        return matchCount;
+    }
+    
+    int getHomeMatches() const {
+        return homeCount;
+    }
+    
+    int getAwayMatches() const {
+        return getTotalMatches() - getHomeMatches();
+    }
+    
+    double getHomeAverage() const {
+        return homeCount > 0 ? static_cast<double>(homeTotal) / homeCount : 0.0;
+    }
+    
+    double getAwayAverage() const {
+        int awayCount = getAwayMatches();
+        return awayCount > 0 ? static_cast<double>(totalScore - homeTotal) / awayCount : 0.0;
+    }
+    
+    const vector<OpponentTotal>& getOpponentTotals() const { return opponentTotals; }
+    
+    // Average against one opponent; the overall average if the player has
+    // not faced them, so no innings reads as neither strong nor weak
+    double getOpponentAverage(const string& opponent) const {
+        for (const auto& entry : opponentTotals) {
+            if (entry.opponent == opponent) {
+                return static_cast<double>(entry.total) / entry.count;
+            }
+        }
+        return getAverageScore();
+    }
+    
+    // Check if player is in form (average of last 3 matches > overall average)
+    bool isInForm() const {
+        if (matchCount < 3) return false;
+        auto recent = getRecentPerformance(3);
+        double recentAvg = accumulate(recent.begin(), recent.end(), 0.0) / recent.size();
+        return recentAvg > getAverageScore();
+    }
+    
+    // Get performance trend (last 5 matches)
+    vector<int> getRecentPerformance(int count = 5) const {
+        if (count <= (int)recentScores.size() || (int)recentScores.size() == matchCount) {
+            int start = max(0, (int)recentScores.size() - count);
+            return vector<int>(recentScores.begin() + start, recentScores.end());
+        }
+        
+        ensureStatsLoaded();
+        vector<int> recent;
+        int start = max(0, (int)stats.size() - count);
+        for (int i = start; i < stats.size(); i++) {
+            recent.push_back(stats[i].score);
+        }
+        return recent;
+    }
+    
+    // File I/O methods
+    // Header line: id|name|role|matches|statsBytes|total|best|homeTotal|homeMatches|recent|opponents
+    // followed by one line per match, where opponents is name=total:count
+    // for every opponent faced. statsBytes lets the loader skip the
+    // history, and the aggregates let it do so without parsing it.
+    void saveHeader(ostream& file, size_t blockBytes) const {
+        file << playerId << "|" << name << "|" << role << "|" << matchCount << "|" << blockBytes
+             << "|" << totalScore << "|" << bestScore << "|" << homeTotal << "|" << homeCount << "|";
+        for (size_t i = 0; i < recentScores.size(); i++) {
+            if (i > 0) file << ",";
+            file << recentScores[i];
+        }
+        file << "|";
+        for (size_t i = 0; i < opponentTotals.size(); i++) {
+            if (i > 0) file << ",";
+            file << escapeOpponent(opponentTotals[i].opponent) << "=" 
+                 << opponentTotals[i].total << ":" << opponentTotals[i].count;
+        }
+        file << "\n";
+    }
+    
+    // The serialized history block, taken from memory or copied from disk
+    string serializeStats() const;
+    
+    // A copy of the history that does not go through the history cache, for
+    // bulk readers that would otherwise evict every other player
+    vector<MatchStats> readStatsUncached() const;
+    
+    void markSaved(long long offset, long long bytes) {
+        statsOffset = offset;
+        statsBytes = bytes;
+        dirty = false;
+    }
+    
+    // Without computeAggregates, an older file's history is skipped line by
+    // line instead of parsed, leaving only the match count and location;
+    // for readers that parse the history themselves
+    void loadFromFile(istream& file, int formatVersion = DATA_FORMAT_VERSION, 
+                      bool computeAggregates = true) {
+        string line;
+        if (getline(file, line)) {
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            vector<string> fields;
+            stringstream ss(line);
+            string field;
+            while (getline(ss, field, '|')) {
+                fields.push_back(field);
+            }
+            if (!line.empty() && line.back() == '|') {
+                fields.push_back("");
+            }
+            if (fields.size() < 4) {
+                throw runtime_error("Malformed player record: " + line);
+            }
+            
+            playerId = stoi(fields[0]);
+            nextId() = max(nextId(), playerId);
+            name = fields[1];
+            role = fields[2];
+            int statsCount = stoi(fields[3]);
+            
+            stats.clear();
+            statsMemory = 0;
+            statsLoaded = false;
+            dirty = false;
+            statsOffset = file.tellg();
+            
+            resetAggregates();
+            if (formatVersion >= 2 && fields.size() >= 11 && loadOpponentTotals(fields[10])) {
+                statsBytes = stoll(fields[4]);
+                matchCount = statsCount;
+                totalScore = stoll(fields[5]);
+                bestScore = stoi(fields[6]);
+                homeTotal = stoll(fields[7]);
+                homeCount = stoi(fields[8]);
+                stringstream recent(fields[9]);
+                string score;
+                while (getline(recent, score, ',')) {
+                    recentScores.push_back(stoi(score));
+                }
+                file.seekg(statsBytes, ios::cur);
+            } else if (!computeAggregates) {
+                resetAggregates();
+                for (int i = 0; i < statsCount; i++) {
+                    file.ignore(numeric_limits<streamsize>::max(), '\n');
+                }
+                if (file.fail()) {
+                    throw runtime_error("Match history for " + name + " is truncated");
+                }
+                matchCount = statsCount;
+                statsBytes = static_cast<long long>(file.tellg()) - statsOffset;
+            } else {
+                // Older files lack some aggregates, or only kept totals for
+                // a fixed list of opponents; compute them in one pass
+                resetAggregates();
+                for (int i = 0; i < statsCount; i++) {
+                    MatchStats stat;
+                    stat.deserialize(file);
+                    addToAggregates(stat);
+                }
+                statsBytes = static_cast<long long>(file.tellg()) - statsOffset;
+            }
+        }
+    }
+    
+    // Read the opponents header field. False if an entry is malformed, in
+    // which case the caller recomputes the aggregates from the history.
+    bool loadOpponentTotals(const string& field) {
+        stringstream opponents(field);
+        string split;
+        while (getline(opponents, split, ',')) {
+            size_t equals = split.find('=');
+            size_t colon = split.find(':', equals);
+            if (equals == string::npos || colon == string::npos) {
+                opponentTotals.clear();
+                return false;
+            }
+            OpponentTotal entry;
+            entry.opponent = unescapeOpponent(split.substr(0, equals));
+            entry.total = stoll(split.substr(equals + 1, colon - equals - 1));
+            entry.count = stoi(split.substr(colon + 1));
+            opponentTotals.push_back(entry);
+        }
+        return true;
+    }
+    
+    // Used by MatchHistoryStore
+    void loadStats(istream& file) const {
+        file.clear();
+        file.seekg(statsOffset);
+        stats.clear();
+        stats.reserve(matchCount);
+        statsMemory = 0;
+        for (int i = 0; i < matchCount; i++) {
+            MatchStats stat;
+            stat.deserialize(file);
+            statsMemory += stat.memoryUsage();
+            stats.push_back(stat);
+        }
+        if (file.fail()) {
+            stats.clear();
+            statsMemory = 0;
+            throw runtime_error("Match history for " + name + " is truncated");
+        }
+        statsLoaded = true;
+    }
+    
+    void releaseStats() const {
+        vector<MatchStats>().swap(stats);
+        statsMemory = 0;
+        statsLoaded = false;
+    }
+    
+    bool canReleaseStats() const { return statsLoaded && !dirty && statsOffset >= 0; }
+    size_t getStatsMemory() const { return statsLoaded ? statsMemory : 0; }
+    long long getStatsOffset() const { return statsOffset; }
+    long long getStatsBytes() const { return statsBytes; }
+};
+
+// Pages per-player match history in from the data file and keeps the most
+// recently used histories resident within a memory budget. Histories with
+// unsaved matches are never evicted.
+class MatchHistoryStore {
+private:
+    string filename;
+    ifstream file;
+    size_t budget;
+    size_t residentBytes;
+    list<const Player*> lru;
+    unordered_map<const Player*, pair<list<const Player*>::iterator, size_t>> entries;
+    
+    void evict(const Player* keep) {
+        auto it = lru.end();
+        while (residentBytes > budget && it != lru.begin()) {
+            --it;
+            const Player* player = *it;
+            if (player == keep || !player->canReleaseStats()) continue;
+            residentBytes -= entries[player].second;
+            entries.erase(player);
+            player->releaseStats();
+            it = lru.erase(it);
+        }
+    }
+    
+public:
+    MatchHistoryStore() : budget(DEFAULT_HISTORY_BUDGET), residentBytes(0) {}
+    
+    void open(const string& name) {
+        close();
+        filename = name;
+        file.open(filename, ios::binary);
+    }
+    
+    void close() {
+        if (file.is_open()) {
+            file.close();
+        }
+    }
+    
+    void setBudget(size_t bytes) {
+        budget = bytes;
+        evict(nullptr);
+    }
+    
+    size_t getResidentBytes() const { return residentBytes; }
+    
+    void load(const Player& player) {
+        if (!file.is_open()) {
+            throw runtime_error("Match history file " + filename + " is not available");
+        }
+        player.loadStats(file);
+        touch(player);
+    }
+    
+    // Mark as most recently used and account for its current size
+    void touch(const Player& player) {
+        size_t bytes = player.getStatsMemory();
+        auto found = entries.find(&player);
+        if (found != entries.end()) {
+            residentBytes -= found->second.second;
+            lru.splice(lru.begin(), lru, found->second.first);
+            found->second.second = bytes;
+        } else {
+            lru.push_front(&player);
+            entries[&player] = make_pair(lru.begin(), bytes);
+        }
+        residentBytes += bytes;
+        evict(&player);
+    }
+    
+    void forget(const Player& player) {
+        auto found = entries.find(&player);
+        if (found != entries.end()) {
+            residentBytes -= found->second.second;
+            lru.erase(found->second.first);
+            entries.erase(found);
+        }
+    }
+    
+    string readBlock(long long offset, long long bytes) {
+        if (!file.is_open()) {
+            throw runtime_error("Match history file " + filename + " is not available");
+        }
+        string block(static_cast<size_t>(bytes), '\0');
+        file.clear();
+        file.seekg(offset);
+        file.read(&block[0], bytes);
+        if (file.gcount() != bytes) {
+            throw runtime_error("Match history file " + filename + " is truncated");
+        }
+        return block;
+    }
+};
+
+inline Player::~Player() {
+    if (history != nullptr) {
+        history->forget(*this);
+    }
+}
+
+// Every access counts as a use, so frequently read histories stay resident
+inline void Player::ensureStatsLoaded() const {
+    if (history == nullptr) return;
+    if (!statsLoaded) {
+        history->load(*this);
+    } else {
+        history->touch(*this);
+    }
+}
+
+inline void Player::notifyHistory() const {
+    if (history != nullptr) {
+        history->touch(*this);
+    }
+}
+
+inline string Player::serializeStats() const {
+    if (!statsLoaded && history != nullptr) {
+        return history->readBlock(statsOffset, statsBytes);
+    }
+    stringstream block;
+    for (const auto& stat : stats) {
+        stat.serialize(block);
+    }
+    return block.str();
+}
+
+inline vector<MatchStats> Player::readStatsUncached() const {
+    if (statsLoaded || history == nullptr) {
+        return stats;
+    }
+    istringstream block(history->readBlock(statsOffset, statsBytes));
+    vector<MatchStats> result(matchCount);
+    for (auto& stat : result) {
+        stat.deserialize(block);
+    }
+    if (block.fail()) {
+        throw runtime_error("Match history for " + name + " is truncated");
+    }
+    return result;
+}
+
+// Swap source in as target in one step, so there is never a moment without
+// a target file. On failure target is left as it was.
+inline bool replaceFile(const string& source, const string& target) {
+#ifdef _WIN32
+    return MoveFileExA(source.c_str(), target.c_str(), 
+                       MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return rename(source.c_str(), target.c_str()) == 0;
+#endif
+}
+
+// PlayerList class
+class PlayerList {
+private:
+    Player* head;
+    Player* tail;
+    int size;
+    MatchHistoryStore history;
+    
+public:
+    PlayerList() : head(nullptr), tail(nullptr), size(0) {}
+    
+    ~PlayerList() {
+        clear();
+    }
+    
+    // Basic operations
+    Player* addPlayer(const string& name, const string& role) {
+        Player* newPlayer = new Player(name, role);
+        newPlayer->attachHistory(&history);
+        
+        if (head == nullptr) {
+            head = tail = newPlayer;
+        } else {
+            tail->setNext(newPlayer);
+            tail = newPlayer;
+        }
+        size++;
+        return newPlayer;
+    }
+    
+    void addPlayerStats(const string& playerName, const MatchStats& match) {
+        Player* current = head;
+        while (current != nullptr) {
+            if (current->getName() == playerName) {
+                current->addMatch(match);
+                return;
+            }
+            current = current->getNext();
+        }
+        cout << "Player '" << playerName << "' not found!" << endl;
+    }
+    
+    // Advanced search and filter methods
+    Player* findPlayer(const string& name) const {
+        Player* current = head;
+        while (current != nullptr) {
+            if (current->getName() == name) {
+                return current;
+            }
+            current = current->getNext();
+        }
+        return nullptr;
+    }
+    
+    Player* findPlayerById(int id) const {
+        Player* current = head;
+        while (current != nullptr) {
+            if (current->getId() == id) {
+                return current;
+            }
+            current = current->getNext();
+        }
+        return nullptr;
+    }
+    
+    vector<Player*> getPlayersByRole(const string& role) const {
+        vector<Player*> result;
+        Player* current = head;
+        while (current != nullptr) {
+            if (current->getRole() == role) {
+                result.push_back(current);
+            }
+            current = current->getNext();
+        }
+        return result;
+    }
+    
+    vector<Player*> getTopPerformers(int count = 5) const {
+        vector<Player*> allPlayers;
+        Player* current = head;
+        while (current != nullptr) {
+            allPlayers.push_back(current);
+            current = current->getNext();
+        }
+        
+        sort(allPlayers.begin(), allPlayers.end(), 
+            [](const Player* a, const Player* b) {
+                return a->getAverageScore() > b->getAverageScore();
+            });
+        
+        if (allPlayers.size() > count) {
+            allPlayers.resize(count);
+        }
+        return allPlayers;
+    }
+    
+    vector<Player*> getPlayersInForm() const {
+        vector<Player*> result;
+        Player* current = head;
+        while (current != nullptr) {
+            if (current->isInForm()) {
+                result.push_back(current);
+            }
+            current = current->getNext();
+        }
+        return result;
+    }
+    
+    // Statistics methods
+    double getTeamAverage() const {
+        if (size == 0) return 0.0;
+        double total = 0.0;
+        int count = 0;
+        Player* current = head;
+        while (current != nullptr) {
+            total += current->getAverageScore();
+            count++;
+            current = current->getNext();
+        }
+        return total / count;
+    }
+    
+    map<string, double> getRoleAverages() const {
+        map<string, double> averages;
+        map<string, int> counts;
+        
+        Player* current = head;
+        while (current != nullptr) {
+            string role = current->getRole();
+            averages[role] += current->getAverageScore();
+            counts[role]++;
+            current = current->getNext();
+        }
+        
+        for (auto& pair : averages) {
+            if (counts[pair.first] > 0) {
+                pair.second /= counts[pair.first];
+            }
+        }
+        
+        return averages;
+    }
+    
+    // File I/O methods
+    // Written to a temporary file and then swapped in, because histories
+    // that are not resident are copied across from the current file.
+    void saveToFile(const string& filename = DATA_FILE) {
+        string tempFile = filename + ".tmp";
+        ofstream file(tempFile, ios::binary);
+        if (!file.is_open()) {
+            cout << "Error: Could not open file for writing!" << endl;
+            return;
+        }
+        
+        vector<pair<long long, long long>> locations;
+        file << size << "|" << DATA_FORMAT_VERSION << "\n";
+        Player* current = head;
+        while (current != nullptr) {
+            string block = current->serializeStats();
+            current->saveHeader(file, block.size());
+            locations.push_back(make_pair(static_cast<long long>(file.tellp()), 
+                                          static_cast<long long>(block.size())));
+            file << block;
+            current = current->getNext();
+        }
+        
+        file.close();
+        if (file.fail()) {
+            cout << "Error: Could not write " << tempFile << endl;
+            return;
+        }
+        
+        // Windows cannot replace a file that is still open, so close it first.
+        // If the replace fails the old file is intact: keep reading history
+        // from it, and keep unsaved matches in memory for the next save.
+        history.close();
+        bool replaced = replaceFile(tempFile, filename);
+        history.open(filename);
+        if (!replaced) {
+            cout << "Error: Could not replace " << filename << "; changes are kept in memory" << endl;
+            remove(tempFile.c_str());
+            return;
+        }
+        
+        size_t index = 0;
+        for (current = head; current != nullptr; current = current->getNext(), index++) {
+            current->markSaved(locations[index].first, locations[index].second);
+        }
+        cout << "Data saved successfully to " << filename << endl;
+    }
+    
+    // Only player headers and aggregates are read; match history stays on
+    // disk until something asks for it. See Player::loadFromFile for
+    // computeAggregates.
+    void loadFromFile(const string& filename = DATA_FILE, bool computeAggregates = true) {
+        ifstream file(filename, ios::binary);
+        if (!file.is_open()) {
+            cout << "No existing data file found. Starting fresh." << endl;
+            return;
+        }
+        
+        clear();
+        try {
+            string countLine;
+            getline(file, countLine);
+            int playerCount = stoi(countLine);
+            size_t separator = countLine.find('|');
+            int formatVersion = separator == string::npos ? 1 : stoi(countLine.substr(separator + 1));
+            
+            for (int i = 0; i < playerCount; i++) {
+                Player* newPlayer = new Player();
+                newPlayer->attachHistory(&history);
+                if (head == nullptr) {
+                    head = tail = newPlayer;
+                } else {
+                    tail->setNext(newPlayer);
+                    tail = newPlayer;
+                }
+                size++;
+                newPlayer->loadFromFile(file, formatVersion, computeAggregates);
+            }
+        } catch (...) {
+            // Never keep a partial list: its history would point into a file
+            // the store never opened
+            clear();
+            throw;
+        }
+        
+        file.close();
+        history.open(filename);
+        cout << "Data loaded successfully from " << filename << endl;
+    }
+    
+    void setHistoryBudget(size_t bytes) { history.setBudget(bytes); }
+    size_t getResidentHistoryBytes() const { return history.getResidentBytes(); }
+    
+    int getSize() const { return size; }
+    
+    Player* getHead() const { return head; }
+    
+    bool deletePlayer(int playerId) {
+        Player* current = head;
+        Player* prev = nullptr;
+        
+        while (current != nullptr) {
+            if (current->getId() == playerId) {
+                if (prev == nullptr) {
+                    head = current->getNext();
+                    if (head == nullptr) {
+                        tail = nullptr;
+                    }
+                } else {
+                    prev->setNext(current->getNext());
+                    if (current->getNext() == nullptr) {
+                        tail = prev;
+                    }
+                }
+                current->setNext(nullptr);
+                delete current;
+                size--;
+                return true;
+            }
+            prev = current;
+            current = current->getNext();
+        }
+        return false;
+    }
+    
+    void clear() {
+        Player* current = head;
+        while (current != nullptr) {
+            Player* next = current->getNext();
+            delete current;
+            current = next;
+        }
+        head = tail = nullptr;
+        size = 0;
+    }
+};
+
+// Simple JSON-like string builder
+class JsonBuilder {
+private:
+    stringstream ss;
+    bool first = true;
+    
+public:
+    JsonBuilder() {
+        ss << "{";
+    }
+    
+    void addString(const string& key, const string& value) {
+        if (!first) ss << ",";
+        ss << "\"" << key << "\":\"" << value << "\"";
+        first = false;
+    }
+    
+    void addNumber(const string& key, int value) {
+        if (!first) ss << ",";
+        ss << "\"" << key << "\":" << value;
+        first = false;
+    }
+    
+    void addNumber(const string& key, long long value) {
+        if (!first) ss << ",";
+        ss << "\"" << key << "\":" << value;
+        first = false;
+    }
+    
+    void addDouble(const string& key, double value) {
+        if (!first) ss << ",";
+        ss << "\"" << key << "\":" << fixed << setprecision(2) << value;
+        first = false;
+    }
+    
+    void addBool(const string& key, bool value) {
+        if (!first) ss << ",";
+        ss << "\"" << key << "\":" << (value ? "true" : "false");
+        first = false;
+    }
+    
+    void addArray(const string& key, const vector<string>& values) {
+        if (!first) ss << ",";
+        ss << "\"" << key << "\":[";
+        for (size_t i = 0; i < values.size(); i++) {
+            if (i > 0) ss << ",";
+            ss << values[i];
+        }
+        ss << "]";
+        first = false;
+    }
+    
+    string build() {
+        ss << "}";
+        return ss.str();
+    }
+};
+
+// A CSV field, quoted when it contains a separator, quote or line break
+inline string csvField(const string& value) {
+    if (value.find_first_of(",\"\n\r") == string::npos) {
+        return value;
+    }
+    string quoted = "\"";
+    for (char c : value) {
+        if (c == '"') quoted += '"';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+// Simple parsing of "key":"value" pairs - in production, use proper JSON parser
+inline string extractValue(const string& json, const string& key) {
+    string searchKey = "\"" + key + "\":\"";
+    size_t pos = json.find(searchKey);
+    if (pos == string::npos) {
+        return "";
+    }
+    
+    pos += searchKey.length();
+    size_t endPos = json.find("\"", pos);
+    if (endPos == string::npos) {
+        return "";
+    }
+    
+    return json.substr(pos, endPos - pos);
+}
+
+#endif
@@ -4,7 +4,8 @@ class CricketStatsUI {
     constructor() {
         this.players = [];
         this.currentTab = 'dashboard';
-        this.apiBaseUrl = 'http://localhost:8080/api';
+        // Same origin when served by the C++ server; fall back for file:// use
+        this.apiBaseUrl = window.location.protocol === 'file:' ? 'http://localhost:8080/api' : '/api';
         this.init();
     }
 
@@ -649,7 +650,7 @@ function testAddPlayer() {
     console.log('Testing Add Player functionality...');
     
     // Test server connection
-    fetch('http://localhost:8080/api/players')
+    fetch(`${cricketUI ? cricketUI.apiBaseUrl : '/api'}/players`)
         .then(response => {
             console.log('Server connection test:', response.status);
             if (response.ok) {
@@ -8,476 +8,1028 @@
 #include <algorithm>
 #include <iomanip>
 #include <numeric>
+#include <ctime>
+#include <chrono>
+#include <cstdint>
+#include <climits>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <deque>
+#include <memory>
+#include <cstdio>
+#include <cmath>
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#endif
+// Raise the select() set size above the Winsock default of 64 sockets
+#define FD_SETSIZE 1024
 #include <winsock2.h>
 #include <ws2tcpip.h>
 
 #pragma comment(lib, "ws2_32.lib")
 
+#include "cricket_stats.h"
+
 using namespace std;
 
 // Constants
-const int MAX_NAME_LENGTH = 50;
-const int MAX_DATE_LENGTH = 20;
-const int MIN_SCORE = 0;
-const int MAX_SCORE = 1000;
-const string DATA_FILE = "cricket_stats.dat";
+const int DEFAULT_SIMILAR_PLAYERS = 5;
+const int MAX_SIMILAR_PLAYERS = 100;
+const int TRACKED_OPPONENT_COUNT = 3;
+const int TRACKED_OPPONENTS_REFRESH_SECONDS = 60;
+const int MAX_CONNECTIONS = FD_SETSIZE - 1;
+const int IDLE_TIMEOUT_SECONDS = 15;
+const size_t MAX_REQUEST_SIZE = 1024 * 1024;
+const int DEFAULT_LISTEN_BACKLOG = SOMAXCONN;
+const int MAX_READS_PER_CYCLE = 32;
+const int MAX_QUEUED_READS = 256;
+const int READ_LATENCY_TARGET_MS = 250;
+const double RATE_LIMIT_PER_SECOND = 20.0;
+const double RATE_LIMIT_BURST = 60.0;
+const size_t MAX_TRACKED_CLIENTS = 10000;
+const int MAX_MUTATIONS_PER_CYCLE = 16;
+const int MAX_QUEUED_MUTATIONS = 64;
+const int MAX_QUEUED_MUTATIONS_PER_CLIENT = 8;
+const double MUTATION_RATE_LIMIT_PER_SECOND = 5.0;
+const double MUTATION_RATE_LIMIT_BURST = 20.0;
+const int RETRY_AFTER_SECONDS = 1;
+const size_t EXPORT_CHUNK_SIZE = 64 * 1024;
+const int EXPORT_CHUNKS_PER_CYCLE = 4;
+const size_t COMPRESSION_THRESHOLD = 1024;
+const int MIN_COMPRESSION_EFFORT = 4;
+const int MAX_COMPRESSION_EFFORT = 128;
+const int BUSY_READY_SOCKETS = 8;
+const int QUERY_WARMUP_SLICE_MS = 5;
+const int QUERY_COLUMNS_IDLE_SECONDS = 600;
+const size_t MAX_CACHED_RESPONSES = 256;
+const string INDEX_FILE = "index.html";
+const vector<pair<string, string>> STATIC_FILES = {
+    {"index.html", "text/html; charset=utf-8"},
+    {"script.js", "application/javascript; charset=utf-8"},
+    {"styles.css", "text/css; charset=utf-8"}
+};
 
-// MatchStats structure
-struct MatchStats {
-    string date;
-    int score;
-    string opponent;
-    string venue;
-    bool isHome;
+// Minimal DEFLATE (RFC 1951) encoder: LZ77 with hash chains and the fixed
+// Huffman code, wrapped as gzip (RFC 1952) or zlib (RFC 1950). maxChain is
+// the number of earlier positions tried per match; lower is faster.
+class Compressor {
+private:
+    static const int WINDOW_SIZE = 32768;
+    static const int HASH_SIZE = 1 << 15;
+    static const int MIN_MATCH = 3;
+    static const int MAX_MATCH = 258;
     
-    MatchStats(string d = "", int s = 0, string opp = "", string v = "", bool home = true) 
-        : date(d), score(s), opponent(opp), venue(v), isHome(home) {}
+    class BitWriter {
+    private:
+        string& out;
+        uint32_t bitBuffer = 0;
+        int bitCount = 0;
+        
+    public:
+        explicit BitWriter(string& o) : out(o) {}
+        
+        void write(uint32_t bits, int count) {
+            bitBuffer |= bits << bitCount;
+            bitCount += count;
+            while (bitCount >= 8) {
+                out += static_cast<char>(bitBuffer & 0xFF);
+                bitBuffer >>= 8;
+                bitCount -= 8;
+            }
+        }
+        
+        // Huffman codes are stored most significant bit first
+        void writeCode(uint32_t code, int length) {
+            uint32_t reversed = 0;
+            for (int i = 0; i < length; i++) {
+                reversed = (reversed << 1) | ((code >> i) & 1);
+            }
+            write(reversed, length);
+        }
+        
+        void flush() {
+            if (bitCount > 0) {
+                out += static_cast<char>(bitBuffer & 0xFF);
+            }
+            bitBuffer = 0;
+            bitCount = 0;
+        }
+    };
     
-    // For file I/O
-    void serialize(ofstream& file) const {
-        file << date << "|" << score << "|" << opponent << "|" << venue << "|" << isHome << endl;
+    static void writeLiteral(BitWriter& bits, int symbol) {
+        if (symbol < 144) bits.writeCode(0x30 + symbol, 8);
+        else if (symbol < 256) bits.writeCode(0x190 + symbol - 144, 9);
+        else if (symbol < 280) bits.writeCode(symbol - 256, 7);
+        else bits.writeCode(0xC0 + symbol - 280, 8);
     }
     
-    void deserialize(ifstream& file) {
-        string line;
-        if (getline(file, line)) {
-            stringstream ss(line);
-            getline(ss, date, '|');
-            string scoreStr;
-            getline(ss, scoreStr, '|');
-            score = stoi(scoreStr);
-            getline(ss, opponent, '|');
-            getline(ss, venue, '|');
-            string homeStr;
-            getline(ss, homeStr, '|');
-            isHome = (homeStr == "1");
-        }
+    static void writeMatch(BitWriter& bits, int length, int distance) {
+        static const int lengthBase[] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27,
+            31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+        static const int lengthExtra[] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+            2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+        static const int distanceBase[] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97,
+            129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289,
+            16385, 24577};
+        static const int distanceExtra[] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5,
+            6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+        
+        int code = 28;
+        while (lengthBase[code] > length) code--;
+        writeLiteral(bits, 257 + code);
+        bits.write(length - lengthBase[code], lengthExtra[code]);
+        
+        code = 29;
+        while (distanceBase[code] > distance) code--;
+        bits.writeCode(code, 5);
+        bits.write(distance - distanceBase[code], distanceExtra[code]);
     }
-};
-
-// Player class
-class Player {
-private:
-    string name;
-    string role;
-    vector<MatchStats> stats;
-    Player* next;
-    int playerId;
-    static int nextId;
     
-public:
-    Player(string n = "", string r = "") : name(n), role(r), next(nullptr) {
-        playerId = ++nextId;
+    static uint32_t hash3(const unsigned char* p) {
+        return ((p[0] << 10) ^ (p[1] << 5) ^ p[2]) & (HASH_SIZE - 1);
     }
     
-    ~Player() {
-        if (next != nullptr) {
-            delete next;
+public:
+    static string deflateRaw(const string& data, int maxChain) {
+        string out;
+        out.reserve(data.size() / 3 + 16);
+        BitWriter bits(out);
+        bits.write(1, 1); // final block
+        bits.write(1, 2); // fixed Huffman codes
+        
+        const unsigned char* input = reinterpret_cast<const unsigned char*>(data.data());
+        int size = static_cast<int>(data.size());
+        vector<int> head(HASH_SIZE, -1);
+        vector<int> prev(WINDOW_SIZE, -1);
+        
+        auto insert = [&](int pos) {
+            uint32_t h = hash3(input + pos);
+            prev[pos & (WINDOW_SIZE - 1)] = head[h];
+            head[h] = pos;
+        };
+        
+        int pos = 0;
+        while (pos < size) {
+            int bestLength = 0, bestDistance = 0;
+            if (pos + MIN_MATCH <= size) {
+                int limit = min(static_cast<int>(MAX_MATCH), size - pos);
+                int candidate = head[hash3(input + pos)];
+                for (int chain = 0; chain < maxChain && candidate >= 0 
+                        && pos - candidate <= WINDOW_SIZE; chain++) {
+                    int length = 0;
+                    while (length < limit && input[candidate + length] == input[pos + length]) {
+                        length++;
+                    }
+                    if (length > bestLength) {
+                        bestLength = length;
+                        bestDistance = pos - candidate;
+                        if (length == limit) break;
+                    }
+                    candidate = prev[candidate & (WINDOW_SIZE - 1)];
+                }
+            }
+            
+            if (bestLength >= MIN_MATCH) {
+                writeMatch(bits, bestLength, bestDistance);
+                for (int i = 0; i < bestLength; i++, pos++) {
+                    if (pos + MIN_MATCH <= size) insert(pos);
+                }
+            } else {
+                writeLiteral(bits, input[pos]);
+                if (pos + MIN_MATCH <= size) insert(pos);
+                pos++;
+            }
         }
+        
+        writeLiteral(bits, 256); // end of block
+        bits.flush();
+        return out;
     }
     
-    // Getters
-    string getName() const { return name; }
-    string getRole() const { return role; }
-    const vector<MatchStats>& getStats() const { return stats; }
-    Player* getNext() const { return next; }
-    int getId() const { return playerId; }
-    
-    // Setters
-    void setNext(Player* next) { this->next = next; }
-    void setName(string n) { name = n; }
-    void setRole(string r) { role = r; }
-    
-    // Add match statistics
-    void addMatch(const MatchStats& match) {
-        stats.push_back(match);
+    static uint32_t crc32(const string& data) {
+        static uint32_t table[256];
+        static bool initialized = false;
+        if (!initialized) {
+            for (uint32_t i = 0; i < 256; i++) {
+                uint32_t c = i;
+                for (int k = 0; k < 8; k++) {
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                }
+                table[i] = c;
+            }
+            initialized = true;
+        }
+        uint32_t crc = 0xFFFFFFFFu;
+        for (unsigned char c : data) {
+            crc = table[(crc ^ c) & 0xFF] ^ (crc >> 8);
+        }
+        return crc ^ 0xFFFFFFFFu;
     }
     
-    // Advanced statistics methods
-    int getBestScore() const {
-        if (stats.empty()) return 0;
-        return max_element(stats.begin(), stats.end(), 
-            [](const MatchStats& a, const MatchStats& b) {
-                return a.score < b.score;
-            })->score;
+    static uint32_t adler32(const string& data) {
+        uint32_t a = 1, b = 0;
+        for (unsigned char c : data) {
+            a = (a + c) % 65521;
+            b = (b + a) % 65521;
+        }
+        return (b << 16) | a;
     }
     
-    double getAverageScore() const {
-        if (stats.empty()) return 0.0;
-        int total = 0;
-        for (const auto& stat : stats) {
-            total += stat.score;
-        }
-        return static_cast<double>(total) / stats.size();
+    static string gzip(const string& data, int maxChain) {
+        string out("\x1f\x8b\x08\x00\x00\x00\x00\x00\x00\xff", 10);
+        out += deflateRaw(data, maxChain);
+        uint32_t crc = crc32(data);
+        uint32_t length = static_cast<uint32_t>(data.size());
+        for (int i = 0; i < 4; i++) out += static_cast<char>((crc >> (8 * i)) & 0xFF);
+        for (int i = 0; i < 4; i++) out += static_cast<char>((length >> (8 * i)) & 0xFF);
+        return out;
     }
     
-    int getTotalMatches() const {
-        return stats.size();
+    // HTTP "deflate" is the zlib format, not raw DEFLATE
+    static string zlib(const string& data, int maxChain) {
+        string out("\x78\x01", 2);
+        out += deflateRaw(data, maxChain);
+        uint32_t checksum = adler32(data);
+        for (int i = 3; i >= 0; i--) out += static_cast<char>((checksum >> (8 * i)) & 0xFF);
+        return out;
     }
     
-    int getHomeMatches() const {
-        return count_if(stats.begin(), stats.end(), 
-            [](const MatchStats& s) { return s.isHome; });
+    static string compress(const string& data, const string& encoding, int maxChain) {
+        return encoding == "gzip" ? gzip(data, maxChain) : zlib(data, maxChain);
     }
+};
+
+// Parsed form of a /api/query body such as
+// {"groupBy":"role,venue","aggregates":"count,avg,p90","opponent":"Australia"}
+struct QueryPlan {
+    vector<string> groupBy;
+    vector<string> aggregates;
+    string role;
+    string opponent;
+    string venue;
+    string home;
+    int dateFrom;
+    int dateTo;
+    bool needsValues;
+};
+
+// Group-by / aggregate engine over every innings. Match data is copied into
+// columns and scanned in fixed-size batches: filters build a selection mask
+// and group keys are computed column by column, so the inner loops are
+// simple enough for the compiler to vectorize. Large tables are split across
+// hardware threads and the partial groups merged.
+//
+// The columns are only built once a query arrives, a few players per loop
+// pass (warmUp), reading history straight from disk so the history cache
+// is left alone. After that they are kept current in place: new innings
+// are appended and a deleted player's rows are cleared in the live column.
+// Columns unused for QUERY_COLUMNS_IDLE_SECONDS are released again.
+class MatchQueryEngine {
+private:
+    static const size_t BATCH_SIZE = 1024;
+    static const size_t PARALLEL_THRESHOLD = 1 << 16;
+    static const size_t MAX_CACHED_PLANS = 256;
     
-    int getAwayMatches() const {
-        return getTotalMatches() - getHomeMatches();
+    struct GroupResult {
+        long long count = 0;
+        long long sum = 0;
+        int minScore = INT_MAX;
+        int maxScore = INT_MIN;
+        vector<int> values;
+    };
+    typedef unordered_map<uint64_t, GroupResult> GroupMap;
+    
+    bool active;
+    chrono::steady_clock::time_point lastQuery;
+    vector<unsigned char> live;
+    size_t deadRows;
+    vector<int> scores;
+    vector<int> dates;
+    vector<int> playerCodes;
+    vector<int> roleCodes;
+    vector<int> opponentCodes;
+    vector<int> venueCodes;
+    vector<int> homeCodes;
+    vector<string> playerNames;
+    vector<int> playerIds;
+    vector<string> roles;
+    vector<string> opponents;
+    vector<string> venues;
+    map<string, int> roleIndex;
+    map<string, int> opponentIndex;
+    map<string, int> venueIndex;
+    unordered_map<int, int> playerCodeById;
+    map<string, QueryPlan> planCache;
+    
+    // Players whose history has not been copied into the columns yet
+    vector<const Player*> warmupQueue;
+    size_t warmupNext;
+    unordered_set<int> warmupPending;
+    
+    static int encode(const string& value, vector<string>& dictionary, map<string, int>& codes) {
+        auto it = codes.find(value);
+        if (it != codes.end()) return it->second;
+        int code = static_cast<int>(dictionary.size());
+        dictionary.push_back(value);
+        codes[value] = code;
+        return code;
     }
     
-    double getHomeAverage() const {
-        int total = 0, count = 0;
-        for (const auto& stat : stats) {
-            if (stat.isHome) {
-                total += stat.score;
-                count++;
-            }
-        }
-        return count > 0 ? static_cast<double>(total) / count : 0.0;
+    static int lookup(const string& value, const vector<string>& dictionary) {
+        auto it = find(dictionary.begin(), dictionary.end(), value);
+        return it == dictionary.end() ? -1 : static_cast<int>(it - dictionary.begin());
     }
     
-    double getAwayAverage() const {
-        int total = 0, count = 0;
-        for (const auto& stat : stats) {
-            if (!stat.isHome) {
-                total += stat.score;
-                count++;
-            }
+
+    static vector<string> splitList(const string& list) {
+        vector<string> items;
+        stringstream ss(list);
+        string item;
+        while (getline(ss, item, ',')) {
+            item.erase(remove(item.begin(), item.end(), ' '), item.end());
+            if (!item.empty()) items.push_back(item);
         }
-        return count > 0 ? static_cast<double>(total) / count : 0.0;
+        return items;
     }
     
-    // Check if player is in form (average of last 3 matches > overall average)
-    bool isInForm() const {
-        if (stats.size() < 3) return false;
-        auto recent = getRecentPerformance(3);
-        double recentAvg = accumulate(recent.begin(), recent.end(), 0.0) / recent.size();
-        return recentAvg > getAverageScore();
+    static bool isPercentile(const string& aggregate) {
+        if (aggregate.size() < 2 || aggregate[0] != 'p') return false;
+        if (!all_of(aggregate.begin() + 1, aggregate.end(), ::isdigit)) return false;
+        int value = stoi(aggregate.substr(1));
+        return value >= 0 && value <= 100;
     }
     
-    // Get performance trend (last 5 matches)
-    vector<int> getRecentPerformance(int count = 5) const {
-        vector<int> recent;
-        int start = max(0, (int)stats.size() - count);
-        for (int i = start; i < stats.size(); i++) {
-            recent.push_back(stats[i].score);
-        }
-        return recent;
+    int playerCode(const Player& player) {
+        auto found = playerCodeById.find(player.getId());
+        if (found != playerCodeById.end()) return found->second;
+        int code = static_cast<int>(playerNames.size());
+        playerNames.push_back(player.getName());
+        playerIds.push_back(player.getId());
+        playerCodeById[player.getId()] = code;
+        return code;
     }
     
-    // File I/O methods
-    void saveToFile(ofstream& file) const {
-        file << playerId << "|" << name << "|" << role << "|" << stats.size() << endl;
-        for (const auto& stat : stats) {
-            stat.serialize(file);
-        }
+    void appendRow(int code, const Player& player, const MatchStats& match) {
+        live.push_back(1);
+        scores.push_back(match.score);
+        dates.push_back(parseDate(match.date));
+        playerCodes.push_back(code);
+        roleCodes.push_back(encode(player.getRole(), roles, roleIndex));
+        opponentCodes.push_back(encode(match.opponent, opponents, opponentIndex));
+        venueCodes.push_back(encode(match.venue, venues, venueIndex));
+        homeCodes.push_back(match.isHome ? 1 : 0);
     }
     
-    void loadFromFile(ifstream& file) {
-        string line;
-        if (getline(file, line)) {
-            stringstream ss(line);
-            string idStr;
-            getline(ss, idStr, '|');
-            playerId = stoi(idStr);
-            getline(ss, name, '|');
-            getline(ss, role, '|');
-            string statsCountStr;
-            getline(ss, statsCountStr, '|');
-            int statsCount = stoi(statsCountStr);
-            
-            stats.clear();
-            for (int i = 0; i < statsCount; i++) {
-                MatchStats stat;
-                stat.deserialize(file);
-                stats.push_back(stat);
+    // Drop cleared rows once they make up half the table
+    void compact() {
+        vector<vector<int>*> columns = {&scores, &dates, &playerCodes, &roleCodes,
+                                        &opponentCodes, &venueCodes, &homeCodes};
+        for (auto column : columns) {
+            size_t kept = 0;
+            for (size_t i = 0; i < live.size(); i++) {
+                if (live[i]) (*column)[kept++] = (*column)[i];
             }
+            column->resize(kept);
         }
+        live.assign(scores.size(), 1);
+        deadRows = 0;
     }
-};
-
-int Player::nextId = 0;
-
-// PlayerList class
-class PlayerList {
-private:
-    Player* head;
-    Player* tail;
-    int size;
     
-public:
-    PlayerList() : head(nullptr), tail(nullptr), size(0) {}
-    
-    ~PlayerList() {
-        clear();
+    static int parseDateFilter(const string& value, const string& name) {
+        if (value.empty()) return 0;
+        int date = parseDate(value);
+        if (date == 0) {
+            throw runtime_error(name + " must be a YYYY-MM-DD date");
+        }
+        return date;
     }
     
-    // Basic operations
-    void addPlayer(const string& name, const string& role) {
-        Player* newPlayer = new Player(name, role);
-        
-        if (head == nullptr) {
-            head = tail = newPlayer;
-        } else {
-            tail->setNext(newPlayer);
-            tail = newPlayer;
+    void startWarmup(const PlayerList& players) {
+        for (Player* current = players.getHead(); current != nullptr; current = current->getNext()) {
+            warmupQueue.push_back(current);
+            warmupPending.insert(current->getId());
         }
-        size++;
     }
     
-    void addPlayerStats(const string& playerName, const MatchStats& match) {
-        Player* current = head;
-        while (current != nullptr) {
-            if (current->getName() == playerName) {
-                current->addMatch(match);
-                return;
-            }
-            current = current->getNext();
+    // Give the column memory back until the next query
+    void release() {
+        vector<unsigned char>().swap(live);
+        vector<vector<int>*> columns = {&scores, &dates, &playerCodes, &roleCodes,
+                                        &opponentCodes, &venueCodes, &homeCodes, &playerIds};
+        for (auto column : columns) {
+            vector<int>().swap(*column);
         }
-        cout << "Player '" << playerName << "' not found!" << endl;
+        vector<string>().swap(playerNames);
+        roles.clear(); opponents.clear(); venues.clear();
+        roleIndex.clear(); opponentIndex.clear(); venueIndex.clear();
+        playerCodeById.clear();
+        deadRows = 0;
+        active = false;
     }
     
-    // Advanced search and filter methods
-    Player* findPlayer(const string& name) const {
-        Player* current = head;
-        while (current != nullptr) {
-            if (current->getName() == name) {
-                return current;
+    const QueryPlan& getPlan(const string& body) {
+        auto cached = planCache.find(body);
+        if (cached != planCache.end()) return cached->second;
+        
+        QueryPlan plan;
+        plan.groupBy = splitList(extractValue(body, "groupBy"));
+        plan.aggregates = splitList(extractValue(body, "aggregates"));
+        if (plan.aggregates.empty()) plan.aggregates = {"count", "avg"};
+        plan.role = extractValue(body, "role");
+        plan.opponent = extractValue(body, "opponent");
+        plan.venue = extractValue(body, "venue");
+        plan.home = extractValue(body, "home");
+        plan.dateFrom = parseDateFilter(extractValue(body, "dateFrom"), "dateFrom");
+        plan.dateTo = parseDateFilter(extractValue(body, "dateTo"), "dateTo");
+        plan.needsValues = false;
+        
+        static const vector<string> groupKeys = {"player", "role", "opponent", "venue", "home", "year"};
+        for (const auto& key : plan.groupBy) {
+            if (find(groupKeys.begin(), groupKeys.end(), key) == groupKeys.end()) {
+                throw runtime_error("Unknown group-by key: " + key);
             }
-            current = current->getNext();
         }
-        return nullptr;
+        for (const auto& aggregate : plan.aggregates) {
+            if (isPercentile(aggregate)) {
+                plan.needsValues = true;
+            } else if (aggregate != "count" && aggregate != "sum" && aggregate != "avg" 
+                       && aggregate != "min" && aggregate != "max") {
+                throw runtime_error("Unknown aggregate: " + aggregate);
+            }
+        }
+        if (!plan.home.empty() && plan.home != "true" && plan.home != "false") {
+            throw runtime_error("home filter must be true or false");
+        }
+        
+        if (planCache.size() >= MAX_CACHED_PLANS) planCache.clear();
+        return planCache[body] = plan;
     }
     
-    Player* findPlayerById(int id) const {
-        Player* current = head;
-        while (current != nullptr) {
-            if (current->getId() == id) {
-                return current;
+    const vector<int>& keyColumn(const string& key) const {
+        if (key == "player") return playerCodes;
+        if (key == "role") return roleCodes;
+        if (key == "opponent") return opponentCodes;
+        if (key == "venue") return venueCodes;
+        if (key == "home") return homeCodes;
+        return dates;
+    }
+    
+    uint64_t keyRadix(const string& key) const {
+        if (key == "player") return playerNames.size();
+        if (key == "role") return roles.size();
+        if (key == "opponent") return opponents.size();
+        if (key == "venue") return venues.size();
+        if (key == "home") return 2;
+        return 10000;
+    }
+    
+    void scanRange(const QueryPlan& plan, const vector<pair<const vector<int>*, int>>& filters,
+                   size_t begin, size_t end, GroupMap& groups) const {
+        vector<unsigned char> mask(BATCH_SIZE);
+        vector<uint64_t> keys(BATCH_SIZE);
+        
+        for (size_t base = begin; base < end; base += BATCH_SIZE) {
+            size_t count = min(static_cast<size_t>(BATCH_SIZE), end - base);
+            
+            copy(live.begin() + base, live.begin() + base + count, mask.begin());
+            for (const auto& filter : filters) {
+                const int* column = filter.first->data() + base;
+                int code = filter.second;
+                for (size_t i = 0; i < count; i++) mask[i] &= (column[i] == code);
+            }
+            if (plan.dateFrom > 0) {
+                const int* column = dates.data() + base;
+                for (size_t i = 0; i < count; i++) mask[i] &= (column[i] >= plan.dateFrom);
+            }
+            if (plan.dateTo > 0) {
+                const int* column = dates.data() + base;
+                for (size_t i = 0; i < count; i++) mask[i] &= (column[i] <= plan.dateTo);
+            }
+            
+            fill(keys.begin(), keys.begin() + count, 0);
+            for (const auto& key : plan.groupBy) {
+                const int* column = keyColumn(key).data() + base;
+                uint64_t radix = keyRadix(key);
+                if (key == "year") {
+                    for (size_t i = 0; i < count; i++) keys[i] = keys[i] * radix + column[i] / 10000;
+                } else {
+                    for (size_t i = 0; i < count; i++) keys[i] = keys[i] * radix + column[i];
+                }
+            }
+            
+            const int* batchScores = scores.data() + base;
+            for (size_t i = 0; i < count; i++) {
+                if (!mask[i]) continue;
+                GroupResult& group = groups[keys[i]];
+                int score = batchScores[i];
+                group.count++;
+                group.sum += score;
+                group.minScore = min(group.minScore, score);
+                group.maxScore = max(group.maxScore, score);
+                if (plan.needsValues) group.values.push_back(score);
             }
-            current = current->getNext();
         }
-        return nullptr;
     }
     
-    vector<Player*> getPlayersByRole(const string& role) const {
-        vector<Player*> result;
-        Player* current = head;
-        while (current != nullptr) {
-            if (current->getRole() == role) {
-                result.push_back(current);
-            }
-            current = current->getNext();
+    static void mergeInto(GroupMap& target, GroupMap& source) {
+        for (auto& pair : source) {
+            GroupResult& group = target[pair.first];
+            group.count += pair.second.count;
+            group.sum += pair.second.sum;
+            group.minScore = min(group.minScore, pair.second.minScore);
+            group.maxScore = max(group.maxScore, pair.second.maxScore);
+            group.values.insert(group.values.end(), pair.second.values.begin(), pair.second.values.end());
         }
-        return result;
     }
     
-    vector<Player*> getTopPerformers(int count = 5) const {
-        vector<Player*> allPlayers;
-        Player* current = head;
-        while (current != nullptr) {
-            allPlayers.push_back(current);
-            current = current->getNext();
+    string formatGroup(const QueryPlan& plan, uint64_t key, GroupResult& group) const {
+        // Decode the mixed-radix key back into one code per group-by column
+        vector<uint64_t> codes(plan.groupBy.size());
+        for (size_t i = plan.groupBy.size(); i-- > 0;) {
+            uint64_t radix = keyRadix(plan.groupBy[i]);
+            codes[i] = key % radix;
+            key /= radix;
         }
         
-        sort(allPlayers.begin(), allPlayers.end(), 
-            [](const Player* a, const Player* b) {
-                return a->getAverageScore() > b->getAverageScore();
-            });
+        JsonBuilder row;
+        for (size_t i = 0; i < plan.groupBy.size(); i++) {
+            const string& name = plan.groupBy[i];
+            if (name == "player") {
+                row.addNumber("playerId", playerIds[codes[i]]);
+                row.addString("player", playerNames[codes[i]]);
+            } else if (name == "role") {
+                row.addString("role", roles[codes[i]]);
+            } else if (name == "opponent") {
+                row.addString("opponent", opponents[codes[i]]);
+            } else if (name == "venue") {
+                row.addString("venue", venues[codes[i]]);
+            } else if (name == "home") {
+                row.addBool("home", codes[i] == 1);
+            } else {
+                row.addNumber("year", static_cast<int>(codes[i]));
+            }
+        }
         
-        if (allPlayers.size() > count) {
-            allPlayers.resize(count);
+        for (const auto& aggregate : plan.aggregates) {
+            if (aggregate == "count") {
+                row.addNumber("count", group.count);
+            } else if (aggregate == "sum") {
+                row.addNumber("sum", group.sum);
+            } else if (aggregate == "avg") {
+                row.addDouble("avg", static_cast<double>(group.sum) / group.count);
+            } else if (aggregate == "min") {
+                row.addNumber("min", group.minScore);
+            } else if (aggregate == "max") {
+                row.addNumber("max", group.maxScore);
+            } else {
+                // Nearest-rank percentile
+                int percent = stoi(aggregate.substr(1));
+                size_t rank = static_cast<size_t>((percent * group.values.size() + 99) / 100);
+                size_t index = rank > 0 ? rank - 1 : 0;
+                nth_element(group.values.begin(), group.values.begin() + index, group.values.end());
+                row.addNumber(aggregate, group.values[index]);
+            }
         }
-        return allPlayers;
+        return row.build();
     }
     
-    vector<Player*> getPlayersInForm() const {
-        vector<Player*> result;
-        Player* current = head;
-        while (current != nullptr) {
-            if (current->isInForm()) {
-                result.push_back(current);
-            }
-            current = current->getNext();
-        }
-        return result;
+public:
+    MatchQueryEngine() : active(false), deadRows(0), warmupNext(0) {}
+    
+    // "2024-03-15" -> 20240315, 0 unless it is a date with a four-digit year
+    static int parseDate(const string& date) {
+        int year = 0, month = 0, day = 0;
+        if (sscanf(date.c_str(), "%d-%d-%d", &year, &month, &day) != 3) return 0;
+        if (year < 1 || year > 9999 || month < 1 || month > 12 || day < 1 || day > 31) return 0;
+        return year * 10000 + month * 100 + day;
     }
     
-    // Statistics methods
-    double getTeamAverage() const {
-        if (size == 0) return 0.0;
-        double total = 0.0;
-        int count = 0;
-        Player* current = head;
-        while (current != nullptr) {
-            total += current->getAverageScore();
-            count++;
-            current = current->getNext();
+    // Called for each query: starts building the columns if they are not
+    // there yet, and reports whether they are complete
+    bool requestColumns(const PlayerList& players) {
+        lastQuery = chrono::steady_clock::now();
+        if (!active) {
+            active = true;
+            startWarmup(players);
         }
-        return total / count;
+        return isReady();
     }
     
-    map<string, double> getRoleAverages() const {
-        map<string, double> averages;
-        map<string, int> counts;
-        
-        Player* current = head;
-        while (current != nullptr) {
-            string role = current->getRole();
-            averages[role] += current->getAverageScore();
-            counts[role]++;
-            current = current->getNext();
+    bool isReady() const { return active && warmupNext >= warmupQueue.size(); }
+    bool isFilling() const { return active && warmupNext < warmupQueue.size(); }
+    
+    // Copy histories into the columns for up to sliceMs, then return to the
+    // loop. Once complete, release the columns if queries have stopped.
+    void warmUp(int sliceMs) {
+        if (!active) return;
+        if (isReady()) {
+            if (chrono::steady_clock::now() - lastQuery > chrono::seconds(QUERY_COLUMNS_IDLE_SECONDS)) {
+                release();
+            }
+            return;
         }
         
-        for (auto& pair : averages) {
-            if (counts[pair.first] > 0) {
-                pair.second /= counts[pair.first];
+        auto deadline = chrono::steady_clock::now() + chrono::milliseconds(sliceMs);
+        while (isFilling() && chrono::steady_clock::now() < deadline) {
+            const Player* player = warmupQueue[warmupNext++];
+            if (player == nullptr) continue;
+            warmupPending.erase(player->getId());
+            int code = playerCode(*player);
+            try {
+                for (const auto& match : player->readStatsUncached()) {
+                    appendRow(code, *player, match);
+                }
+            } catch (const exception& e) {
+                cerr << "Query columns skip " << player->getName() << ": " << e.what() << endl;
             }
         }
-        
-        return averages;
+        if (isReady()) {
+            vector<const Player*>().swap(warmupQueue);
+            warmupNext = 0;
+            warmupPending.clear();
+        }
+    }
+    
+    void addMatch(const Player& player, const MatchStats& match) {
+        // Still queued: the new innings is picked up with the rest of its history
+        if (!active || warmupPending.count(player.getId())) return;
+        appendRow(playerCode(player), player, match);
     }
     
-    // File I/O methods
-    void saveToFile(const string& filename = DATA_FILE) const {
-        ofstream file(filename);
-        if (!file.is_open()) {
-            cout << "Error: Could not open file for writing!" << endl;
+    void removePlayer(int playerId) {
+        if (!active) return;
+        if (warmupPending.erase(playerId)) {
+            for (size_t i = warmupNext; i < warmupQueue.size(); i++) {
+                if (warmupQueue[i] != nullptr && warmupQueue[i]->getId() == playerId) {
+                    warmupQueue[i] = nullptr;
+                }
+            }
             return;
         }
         
-        file << size << endl;
-        Player* current = head;
-        while (current != nullptr) {
-            current->saveToFile(file);
-            current = current->getNext();
+        auto found = playerCodeById.find(playerId);
+        if (found == playerCodeById.end()) return;
+        int code = found->second;
+        playerCodeById.erase(found);
+        for (size_t i = 0; i < playerCodes.size(); i++) {
+            if (playerCodes[i] == code && live[i]) {
+                live[i] = 0;
+                deadRows++;
+            }
+        }
+        if (deadRows * 2 > live.size()) {
+            compact();
         }
-        
-        file.close();
-        cout << "Data saved successfully to " << filename << endl;
     }
     
-    void loadFromFile(const string& filename = DATA_FILE) {
-        ifstream file(filename);
-        if (!file.is_open()) {
-            cout << "No existing data file found. Starting fresh." << endl;
-            return;
+    string execute(const string& body) {
+        auto startTime = chrono::steady_clock::now();
+        lastQuery = startTime;
+        const QueryPlan& plan = getPlan(body);
+        
+        uint64_t groupSpace = 1;
+        for (const auto& key : plan.groupBy) {
+            uint64_t radix = max<uint64_t>(1, keyRadix(key));
+            if (groupSpace > UINT64_MAX / radix) {
+                throw runtime_error("Too many group-by keys");
+            }
+            groupSpace *= radix;
         }
         
-        clear();
-        int playerCount;
-        file >> playerCount;
-        file.ignore();
+        // Resolve equality filters to dictionary codes; an unknown value matches nothing
+        vector<pair<const vector<int>*, int>> filters;
+        bool matchesNothing = false;
+        auto addFilter = [&](const string& value, const vector<int>& column, const vector<string>& dictionary) {
+            if (value.empty()) return;
+            int code = lookup(value, dictionary);
+            if (code < 0) matchesNothing = true;
+            filters.push_back(make_pair(&column, code));
+        };
+        addFilter(plan.role, roleCodes, roles);
+        addFilter(plan.opponent, opponentCodes, opponents);
+        addFilter(plan.venue, venueCodes, venues);
+        if (!plan.home.empty()) {
+            filters.push_back(make_pair(&homeCodes, plan.home == "true" ? 1 : 0));
+        }
         
-        for (int i = 0; i < playerCount; i++) {
-            Player* newPlayer = new Player();
-            newPlayer->loadFromFile(file);
-            
-            if (head == nullptr) {
-                head = tail = newPlayer;
+        GroupMap groups;
+        size_t rows = scores.size();
+        if (!matchesNothing) {
+            unsigned threadCount = max(1u, thread::hardware_concurrency());
+            if (rows < PARALLEL_THRESHOLD || threadCount == 1) {
+                scanRange(plan, filters, 0, rows, groups);
             } else {
-                tail->setNext(newPlayer);
-                tail = newPlayer;
+                size_t batches = (rows + BATCH_SIZE - 1) / BATCH_SIZE;
+                size_t perThread = (batches + threadCount - 1) / threadCount * BATCH_SIZE;
+                vector<GroupMap> partials(threadCount);
+                vector<thread> workers;
+                for (unsigned t = 0; t < threadCount; t++) {
+                    size_t begin = min(rows, t * perThread);
+                    size_t end = min(rows, begin + perThread);
+                    workers.emplace_back([&, t, begin, end]() {
+                        scanRange(plan, filters, begin, end, partials[t]);
+                    });
+                }
+                for (auto& worker : workers) worker.join();
+                for (auto& partial : partials) mergeInto(groups, partial);
             }
-            size++;
         }
         
-        file.close();
-        cout << "Data loaded successfully from " << filename << endl;
+        vector<uint64_t> keys;
+        long long matched = 0;
+        for (const auto& pair : groups) {
+            keys.push_back(pair.first);
+            matched += pair.second.count;
+        }
+        sort(keys.begin(), keys.end());
+        
+        vector<string> rowsJson;
+        for (uint64_t key : keys) {
+            rowsJson.push_back(formatGroup(plan, key, groups[key]));
+        }
+        
+        double elapsedMs = chrono::duration<double, milli>(chrono::steady_clock::now() - startTime).count();
+        JsonBuilder result;
+        result.addNumber("matchedInnings", matched);
+        result.addNumber("groupCount", static_cast<int>(rowsJson.size()));
+        result.addDouble("elapsedMs", elapsedMs);
+        result.addArray("groups", rowsJson);
+        return result.build();
     }
+};
+
+// Nearest-neighbour index over per-player feature vectors built from the
+// aggregates: average, best, home and away averages, recent form and the
+// averages against each tracked opponent. The tracked opponents are the
+// ones with the most innings across all players, re-picked at most once a
+// minute. Vectors live in one contiguous array and are
+// updated in place whenever a player's aggregates change. Queries scan the
+// whole array with an SSE distance kernel where available; each dimension
+// is weighted by 1/variance so that no single statistic dominates.
+class SimilarityIndex {
+public:
+    static const int DIMENSIONS = 8;
+    static_assert(5 + TRACKED_OPPONENT_COUNT == DIMENSIONS, "the SSE kernel expects 8 features");
     
-    int getSize() const { return size; }
+private:
+    vector<float> features;
+    vector<const Player*> players;
+    unordered_map<int, size_t> slots;
+    double sums[DIMENSIONS];
+    double squares[DIMENSIONS];
+    vector<string> trackedOpponents;
+    bool opponentsStale;
+    chrono::steady_clock::time_point opponentsPicked;
     
-    Player* getHead() const { return head; }
+    void buildFeatures(const Player& player, float* out) const {
+        vector<int> recent = player.getRecentPerformance(RECENT_SCORES_KEPT);
+        double recentAverage = recent.empty() ? 0.0 
+            : accumulate(recent.begin(), recent.end(), 0.0) / recent.size();
+        out[0] = static_cast<float>(player.getAverageScore());
+        out[1] = static_cast<float>(player.getBestScore());
+        out[2] = static_cast<float>(player.getHomeAverage());
+        out[3] = static_cast<float>(player.getAwayAverage());
+        out[4] = static_cast<float>(recentAverage);
+        for (int i = 0; i < TRACKED_OPPONENT_COUNT; i++) {
+            out[5 + i] = static_cast<float>(i < (int)trackedOpponents.size() 
+                ? player.getOpponentAverage(trackedOpponents[i]) : player.getAverageScore());
+        }
+    }
     
-    bool deletePlayer(int playerId) {
-        Player* current = head;
-        Player* prev = nullptr;
-        
-        while (current != nullptr) {
-            if (current->getId() == playerId) {
-                if (prev == nullptr) {
-                    head = current->getNext();
-                    if (head == nullptr) {
-                        tail = nullptr;
-                    }
-                } else {
-                    prev->setNext(current->getNext());
-                    if (current->getNext() == nullptr) {
-                        tail = prev;
-                    }
-                }
-                delete current;
-                size--;
-                return true;
-            }
-            prev = current;
-            current = current->getNext();
+    void account(const float* values, double sign) {
+        for (int d = 0; d < DIMENSIONS; d++) {
+            sums[d] += sign * values[d];
+            squares[d] += sign * values[d] * values[d];
         }
-        return false;
     }
     
-    void clear() {
-        Player* current = head;
-        while (current != nullptr) {
-            Player* next = current->getNext();
-            delete current;
-            current = next;
+    static float distance(const float* a, const float* b, const float* weights) {
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+        __m128 low = _mm_sub_ps(_mm_loadu_ps(a), _mm_loadu_ps(b));
+        __m128 high = _mm_sub_ps(_mm_loadu_ps(a + 4), _mm_loadu_ps(b + 4));
+        __m128 sum = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(low, low), _mm_loadu_ps(weights)),
+                                _mm_mul_ps(_mm_mul_ps(high, high), _mm_loadu_ps(weights + 4)));
+        sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+        sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+        return _mm_cvtss_f32(sum);
+#else
+        float sum = 0.0f;
+        for (int d = 0; d < DIMENSIONS; d++) {
+            float diff = a[d] - b[d];
+            sum += diff * diff * weights[d];
         }
-        head = tail = nullptr;
-        size = 0;
+        return sum;
+#endif
     }
-};
-
-// Simple JSON-like string builder
-class JsonBuilder {
-private:
-    stringstream ss;
-    bool first = true;
     
 public:
-    JsonBuilder() {
-        ss << "{";
+    SimilarityIndex() : opponentsStale(true) {
+        for (int d = 0; d < DIMENSIONS; d++) {
+            sums[d] = squares[d] = 0.0;
+        }
     }
     
-    void addString(const string& key, const string& value) {
-        if (!first) ss << ",";
-        ss << "\"" << key << "\":\"" << value << "\"";
-        first = false;
+    // Re-pick the tracked opponents if players changed since the last pick
+    // and enough time has passed, rebuilding every vector if the pick differs
+    void refreshTrackedOpponents() {
+        auto now = chrono::steady_clock::now();
+        if (!opponentsStale || (!trackedOpponents.empty() 
+                && now - opponentsPicked < chrono::seconds(TRACKED_OPPONENTS_REFRESH_SECONDS))) {
+            return;
+        }
+        opponentsStale = false;
+        opponentsPicked = now;
+        
+        unordered_map<string, long long> innings;
+        for (const Player* player : players) {
+            for (const auto& entry : player->getOpponentTotals()) {
+                innings[entry.opponent] += entry.count;
+            }
+        }
+        vector<pair<long long, string>> ranked;
+        for (const auto& entry : innings) {
+            if (!entry.first.empty()) ranked.push_back(make_pair(-entry.second, entry.first));
+        }
+        size_t count = min(ranked.size(), static_cast<size_t>(TRACKED_OPPONENT_COUNT));
+        partial_sort(ranked.begin(), ranked.begin() + count, ranked.end());
+        
+        vector<string> picked;
+        for (size_t i = 0; i < count; i++) {
+            picked.push_back(ranked[i].second);
+        }
+        if (picked == trackedOpponents) return;
+        
+        trackedOpponents = picked;
+        for (int d = 0; d < DIMENSIONS; d++) {
+            sums[d] = squares[d] = 0.0;
+        }
+        for (size_t slot = 0; slot < players.size(); slot++) {
+            float* values = &features[slot * DIMENSIONS];
+            buildFeatures(*players[slot], values);
+            account(values, 1.0);
+        }
     }
     
-    void addNumber(const string& key, int value) {
-        if (!first) ss << ",";
-        ss << "\"" << key << "\":" << value;
-        first = false;
+    void upsert(const Player& player) {
+        opponentsStale = true;
+        float values[DIMENSIONS];
+        buildFeatures(player, values);
+        
+        auto found = slots.find(player.getId());
+        size_t slot;
+        if (found == slots.end()) {
+            slot = players.size();
+            slots[player.getId()] = slot;
+            players.push_back(&player);
+            features.resize(features.size() + DIMENSIONS);
+        } else {
+            slot = found->second;
+            account(&features[slot * DIMENSIONS], -1.0);
+        }
+        copy(values, values + DIMENSIONS, features.begin() + slot * DIMENSIONS);
+        account(values, 1.0);
     }
     
-    void addDouble(const string& key, double value) {
-        if (!first) ss << ",";
-        ss << "\"" << key << "\":" << fixed << setprecision(2) << value;
-        first = false;
+    void remove(int playerId) {
+        auto found = slots.find(playerId);
+        if (found == slots.end()) return;
+        
+        opponentsStale = true;
+        size_t slot = found->second;
+        size_t last = players.size() - 1;
+        account(&features[slot * DIMENSIONS], -1.0);
+        if (slot != last) {
+            copy(features.begin() + last * DIMENSIONS, features.begin() + (last + 1) * DIMENSIONS,
+                 features.begin() + slot * DIMENSIONS);
+            players[slot] = players[last];
+            slots[players[slot]->getId()] = slot;
+        }
+        players.pop_back();
+        features.resize(last * DIMENSIONS);
+        slots.erase(found);
     }
     
-    void addBool(const string& key, bool value) {
-        if (!first) ss << ",";
-        ss << "\"" << key << "\":" << (value ? "true" : "false");
-        first = false;
-    }
+    bool contains(int playerId) const { return slots.count(playerId) > 0; }
     
-    void addArray(const string& key, const vector<string>& values) {
-        if (!first) ss << ",";
-        ss << "\"" << key << "\":[";
-        for (size_t i = 0; i < values.size(); i++) {
-            if (i > 0) ss << ",";
-            ss << values[i];
+    // The k players closest to playerId, nearest first, with their distance
+    vector<pair<const Player*, float>> nearest(int playerId, int k) const {
+        vector<pair<const Player*, float>> result;
+        auto found = slots.find(playerId);
+        if (found == slots.end() || players.size() < 2) return result;
+        
+        float weights[DIMENSIONS];
+        double count = static_cast<double>(players.size());
+        for (int d = 0; d < DIMENSIONS; d++) {
+            double mean = sums[d] / count;
+            double variance = squares[d] / count - mean * mean;
+            weights[d] = variance > 1e-9 ? static_cast<float>(1.0 / variance) : 0.0f;
         }
-        ss << "]";
-        first = false;
+        
+        // Max-heap on distance holding the best k seen so far
+        auto farther = [](const pair<float, size_t>& a, const pair<float, size_t>& b) { 
+            return a.first < b.first; 
+        };
+        vector<pair<float, size_t>> heap;
+        heap.reserve(k + 1);
+        const float* target = &features[found->second * DIMENSIONS];
+        for (size_t slot = 0; slot < players.size(); slot++) {
+            if (slot == found->second) continue;
+            float d = distance(target, &features[slot * DIMENSIONS], weights);
+            if ((int)heap.size() < k) {
+                heap.push_back(make_pair(d, slot));
+                push_heap(heap.begin(), heap.end(), farther);
+            } else if (d < heap.front().first) {
+                pop_heap(heap.begin(), heap.end(), farther);
+                heap.back() = make_pair(d, slot);
+                push_heap(heap.begin(), heap.end(), farther);
+            }
+        }
+        
+        sort_heap(heap.begin(), heap.end(), farther);
+        for (const auto& entry : heap) {
+            result.push_back(make_pair(players[entry.second], sqrt(entry.first)));
+        }
+        return result;
     }
+};
+
+// Complete request waiting for the scheduler. A non-empty rejection is the
+// status sent instead of running it, kept in order with pipelined requests.
+struct PendingRequest {
+    string raw;
+    bool mutation;
+    bool countedAsRead;
+    bool countedAsMutation;
+    string rejection;
+    chrono::steady_clock::time_point queuedAt;
+};
+
+// Player as seen when an export started; player is cleared if it is deleted
+// mid-export and its rows are then read from detachedRows instead
+struct ExportEntry {
+    Player* player;
+    int id;
+    string name;
+    string role;
+    size_t matchCount;
+    vector<MatchStats> detachedRows;
+};
+
+// Position of a streaming export. Only the roster is copied up front; rows
+// are formatted a chunk at a time, and matches added after the export
+// started are excluded, so the output is a consistent snapshot.
+struct ExportCursor {
+    string format;
+    vector<ExportEntry> entries;
+    size_t entryIndex;
+    size_t matchIndex;
+};
+
+// Per-connection state for the select() event loop
+struct Connection {
+    SOCKET socket;
+    uint32_t clientAddress;
+    string inBuffer;
+    string outBuffer;
+    size_t outOffset;
+    deque<PendingRequest> pending;
+    int queuedReads;
+    int queuedMutations;
+    shared_ptr<ExportCursor> exportCursor;
+    bool closeWhenDrained;
+    bool closeAfterWrite;
+    time_t lastActive;
     
-    string build() {
-        ss << "}";
-        return ss.str();
-    }
+    Connection(SOCKET s = INVALID_SOCKET, uint32_t address = 0) 
+        : socket(s), clientAddress(address), outOffset(0), queuedReads(0), 
+          queuedMutations(0), closeWhenDrained(false), closeAfterWrite(false), 
+          lastActive(time(nullptr)) {}
+    
+    bool hasPendingOutput() const { return outOffset < outBuffer.size(); }
+    bool canRun() const { return !pending.empty() && !closeAfterWrite && !exportCursor; }
+    bool canExport() const { return exportCursor && outBuffer.size() - outOffset < EXPORT_CHUNK_SIZE; }
+};
+
+// Per-client request allowance, refilled continuously
+struct TokenBucket {
+    double tokens;
+    chrono::steady_clock::time_point lastRefill;
+};
+
+// Frontend file held in memory so it can be served without touching disk
+struct StaticAsset {
+    string contentType;
+    string body;
+    string etag;
+    string cacheControl;
+    string gzipBody;
+};
+
+// Encoded API response, valid while the data version is unchanged
+struct CachedResponse {
+    string body;
+    string headers;
 };
 
 // Cricket API Server
@@ -486,9 +1038,20 @@ private:
     PlayerList playerList;
     SOCKET serverSocket;
     bool running;
+    vector<Connection> connections;
+    map<uint32_t, TokenBucket> rateLimits;
+    map<uint32_t, TokenBucket> mutationRateLimits;
+    map<string, StaticAsset> staticAssets;
+    map<string, CachedResponse> responseCache;
+    unsigned long responseCacheVersion;
+    MatchQueryEngine queryEngine;
+    SimilarityIndex similarityIndex;
+    unsigned long dataVersion;
+    int compressionEffort;
     
 public:
-    CricketAPI() : running(false) {
+    CricketAPI() : running(false), responseCacheVersion(0), dataVersion(0), 
+                   compressionEffort(MAX_COMPRESSION_EFFORT) {
         // Initialize Winsock
         WSADATA wsaData;
         int result = WSAStartup(MAKEWORD(2, 2), &wsaData);
@@ -503,8 +1066,24 @@ public:
             cout << "Data loaded successfully from " << DATA_FILE << endl;
         } catch (const exception& e) {
             cout << "Warning: Could not load data from " << DATA_FILE << ": " << e.what() << endl;
+            // Keep the unreadable file; the next save would otherwise replace it
+            string preserved = DATA_FILE + ".corrupt";
+            if (replaceFile(DATA_FILE, preserved)) {
+                cout << "Moved it to " << preserved << endl;
+            }
             cout << "Starting with empty player list." << endl;
         }
+        
+        for (Player* current = playerList.getHead(); current != nullptr; current = current->getNext()) {
+            similarityIndex.upsert(*current);
+        }
+        similarityIndex.refreshTrackedOpponents();
+        
+        loadStaticAssets();
+    }
+    
+    void setHistoryBudget(size_t bytes) {
+        playerList.setHistoryBudget(bytes);
     }
     
     ~CricketAPI() {
@@ -514,7 +1093,7 @@ public:
         WSACleanup();
     }
     
-    void start(int port = 8080) {
+    void start(int port = 8080, int backlog = DEFAULT_LISTEN_BACKLOG) {
         serverSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
         if (serverSocket == INVALID_SOCKET) {
             cerr << "Failed to create socket: " << WSAGetLastError() << endl;
@@ -536,71 +1115,520 @@ public:
             return;
         }
         
-        if (listen(serverSocket, 10) == SOCKET_ERROR) {
+        if (listen(serverSocket, backlog) == SOCKET_ERROR) {
             cerr << "Failed to listen: " << WSAGetLastError() << endl;
             closesocket(serverSocket);
             return;
         }
+        setNonBlocking(serverSocket);
         
         running = true;
         cout << "Cricket API Server running on port " << port << endl;
+        cout << "Frontend: http://localhost:" << port << "/" << endl;
         cout << "Available endpoints:" << endl;
         cout << "  GET  /api/players     - Get all players" << endl;
         cout << "  GET  /api/players/top - Get top performers" << endl;
         cout << "  GET  /api/players/form - Get players in form" << endl;
+        cout << "  GET  /api/players/{id}/similar?k=N - Similar players" << endl;
         cout << "  GET  /api/stats       - Get team statistics" << endl;
+        cout << "  GET  /api/export?format=ndjson|csv - Stream every innings" << endl;
         cout << "  POST /api/players     - Add new player" << endl;
         cout << "  POST /api/matches     - Add match statistics" << endl;
+        cout << "  POST /api/query       - Group-by / aggregate query" << endl;
         cout << "  DELETE /api/players/{id} - Delete player" << endl;
         
+        // Single-threaded event loop: one select() call reports every ready
+        // socket, so accepts, reads and writes are handled in batches and
+        // keep-alive clients reuse their connection across requests.
+        // Complete requests are queued and run by processQueuedRequests.
         while (running) {
-            sockaddr_in clientAddr;
-            int clientLen = sizeof(clientAddr);
-            SOCKET clientSocket = accept(serverSocket, (sockaddr*)&clientAddr, &clientLen);
+            fd_set readSet, writeSet;
+            FD_ZERO(&readSet);
+            FD_ZERO(&writeSet);
             
-            if (clientSocket == INVALID_SOCKET) {
+            SOCKET maxSocket = serverSocket;
+            FD_SET(serverSocket, &readSet);
+            bool queued = false;
+            for (const auto& conn : connections) {
+                if (!conn.closeWhenDrained) {
+                    FD_SET(conn.socket, &readSet);
+                }
+                if (conn.hasPendingOutput()) {
+                    FD_SET(conn.socket, &writeSet);
+                }
+                queued = queued || conn.canRun() || conn.canExport();
+                maxSocket = max(maxSocket, conn.socket);
+            }
+            queued = queued || queryEngine.isFilling();
+            
+            // Poll without waiting while reads are still queued from the last pass
+            timeval timeout;
+            timeout.tv_sec = queued ? 0 : 1;
+            timeout.tv_usec = 0;
+            int ready = select((int)maxSocket + 1, &readSet, &writeSet, nullptr, &timeout);
+            if (ready == SOCKET_ERROR) {
+                cerr << "select failed: " << WSAGetLastError() << endl;
                 continue;
             }
+            adjustCompressionEffort(ready);
+            
+            time_t now = time(nullptr);
+            for (auto& conn : connections) {
+                if (FD_ISSET(conn.socket, &readSet)) {
+                    conn.lastActive = now;
+                    handleRead(conn);
+                }
+                if (conn.hasPendingOutput() && FD_ISSET(conn.socket, &writeSet)) {
+                    flushOutput(conn);
+                }
+            }
+            
+            if (ready > 0 && FD_ISSET(serverSocket, &readSet)) {
+                acceptConnections();
+            }
             
-            // Handle client in the same thread (simplified)
-            handleClient(clientSocket);
+            processQueuedRequests();
+            queryEngine.warmUp(QUERY_WARMUP_SLICE_MS);
+            for (auto& conn : connections) {
+                for (int i = 0; i < EXPORT_CHUNKS_PER_CYCLE && conn.canExport(); i++) {
+                    try {
+                        writeExportChunk(conn);
+                    } catch (const exception& e) {
+                        // The status line is long gone; ending the connection
+                        // without the final chunk tells the client it failed
+                        cerr << "Export aborted: " << e.what() << endl;
+                        conn.exportCursor.reset();
+                        conn.closeAfterWrite = true;
+                    }
+                    flushOutput(conn);
+                }
+                if (conn.hasPendingOutput()) {
+                    flushOutput(conn);
+                }
+            }
+            
+            closeFinishedConnections(now);
         }
     }
     
     void stop() {
         running = false;
+        for (auto& conn : connections) {
+            closesocket(conn.socket);
+        }
+        connections.clear();
         closesocket(serverSocket);
     }
     
 private:
-    void handleClient(SOCKET clientSocket) {
-        char buffer[4096];
-        int bytesRead = recv(clientSocket, buffer, sizeof(buffer) - 1, 0);
-        
-        if (bytesRead > 0) {
-            buffer[bytesRead] = '\0';
-            string request(buffer);
+    static void setNonBlocking(SOCKET socket) {
+        u_long mode = 1;
+        ioctlsocket(socket, FIONBIO, &mode);
+    }
+    
+    static bool wouldBlock() {
+        return WSAGetLastError() == WSAEWOULDBLOCK;
+    }
+    
+    // Halve the LZ77 search effort while many sockets are ready at once and
+    // restore it gradually when the server is quiet.
+    void adjustCompressionEffort(int readySockets) {
+        if (readySockets >= BUSY_READY_SOCKETS) {
+            compressionEffort = max(MIN_COMPRESSION_EFFORT, compressionEffort / 2);
+        } else {
+            compressionEffort = min(MAX_COMPRESSION_EFFORT, compressionEffort + 1);
+        }
+    }
+    
+    void acceptConnections() {
+        while (true) {
+            sockaddr_in clientAddr;
+            int clientLen = sizeof(clientAddr);
+            SOCKET clientSocket = accept(serverSocket, (sockaddr*)&clientAddr, &clientLen);
+            
+            if (clientSocket == INVALID_SOCKET) {
+                break;
+            }
+            
+            // Over capacity: answer straight away rather than leave the
+            // client waiting in the listen backlog
+            if ((int)connections.size() >= MAX_CONNECTIONS) {
+                string response = rejectionResponse("503 Service Unavailable", false);
+                send(clientSocket, response.c_str(), (int)response.length(), 0);
+                closesocket(clientSocket);
+                continue;
+            }
             
-            string response = processRequest(request);
-            send(clientSocket, response.c_str(), response.length(), 0);
+            setNonBlocking(clientSocket);
+            int noDelay = 1;
+            setsockopt(clientSocket, IPPROTO_TCP, TCP_NODELAY, (char*)&noDelay, sizeof(noDelay));
+            connections.push_back(Connection(clientSocket, (uint32_t)clientAddr.sin_addr.s_addr));
+        }
+    }
+    
+    // Drain the socket and queue every complete request in the buffer
+    void handleRead(Connection& conn) {
+        char buffer[8192];
+        while (true) {
+            int bytesRead = recv(conn.socket, buffer, sizeof(buffer), 0);
+            if (bytesRead > 0) {
+                conn.inBuffer.append(buffer, bytesRead);
+                if (conn.inBuffer.size() > MAX_REQUEST_SIZE) {
+                    break;
+                }
+                continue;
+            }
+            if (bytesRead == 0) {
+                // Peer finished sending; answer what it already sent
+                conn.closeWhenDrained = true;
+                break;
+            }
+            if (!wouldBlock()) {
+                // Connection failed; drop any queued work and unsent output
+                conn.outBuffer.clear();
+                conn.outOffset = 0;
+                conn.pending.clear();
+                conn.queuedReads = 0;
+                conn.queuedMutations = 0;
+                conn.exportCursor.reset();
+                conn.closeAfterWrite = true;
+                return;
+            }
+            break;
+        }
+        
+        string request;
+        while (extractRequest(conn.inBuffer, request)) {
+            enqueueRequest(conn, request);
+        }
+        
+        if (conn.inBuffer.size() > MAX_REQUEST_SIZE) {
+            PendingRequest tooLarge;
+            tooLarge.mutation = false;
+            tooLarge.countedAsRead = false;
+            tooLarge.countedAsMutation = false;
+            tooLarge.rejection = "413 Payload Too Large";
+            tooLarge.queuedAt = chrono::steady_clock::now();
+            conn.pending.push_back(tooLarge);
+            conn.inBuffer.clear();
+            conn.closeWhenDrained = true;
+        }
+    }
+    
+    // Reads are admitted only while the client is within its rate limit and
+    // the shared read queue is below its bound; mutations are always queued.
+    void enqueueRequest(Connection& conn, const string& raw) {
+        string method, path;
+        istringstream(raw) >> method >> path;
+        
+        PendingRequest request;
+        request.raw = raw;
+        request.mutation = isMutation(method, path);
+        request.countedAsRead = false;
+        request.countedAsMutation = false;
+        request.queuedAt = chrono::steady_clock::now();
+        
+        if (request.mutation) {
+            if (!allowRequest(mutationRateLimits, conn.clientAddress, request.queuedAt,
+                              MUTATION_RATE_LIMIT_PER_SECOND, MUTATION_RATE_LIMIT_BURST)) {
+                request.rejection = "429 Too Many Requests";
+            } else if (conn.queuedMutations >= MAX_QUEUED_MUTATIONS_PER_CLIENT
+                       || queuedMutations() >= MAX_QUEUED_MUTATIONS) {
+                request.rejection = "503 Service Unavailable";
+            } else {
+                request.countedAsMutation = true;
+                conn.queuedMutations++;
+            }
+        } else {
+            if (!allowRequest(rateLimits, conn.clientAddress, request.queuedAt,
+                              RATE_LIMIT_PER_SECOND, RATE_LIMIT_BURST)) {
+                request.rejection = "429 Too Many Requests";
+            } else if (queuedReads() >= MAX_QUEUED_READS) {
+                request.rejection = "503 Service Unavailable";
+            } else {
+                request.countedAsRead = true;
+                conn.queuedReads++;
+            }
+        }
+        conn.pending.push_back(request);
+    }
+    
+    int queuedReads() const {
+        int total = 0;
+        for (const auto& conn : connections) {
+            total += conn.queuedReads;
+        }
+        return total;
+    }
+    
+    int queuedMutations() const {
+        int total = 0;
+        for (const auto& conn : connections) {
+            total += conn.queuedMutations;
+        }
+        return total;
+    }
+    
+    bool allowRequest(map<uint32_t, TokenBucket>& buckets, uint32_t client,
+                      chrono::steady_clock::time_point now, double rate, double burst) {
+        if (buckets.size() > MAX_TRACKED_CLIENTS) {
+            // Forget clients whose bucket has refilled completely
+            for (auto it = buckets.begin(); it != buckets.end();) {
+                double idleSeconds = chrono::duration<double>(now - it->second.lastRefill).count();
+                if (it->second.tokens + idleSeconds * rate >= burst) {
+                    it = buckets.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+        
+        auto it = buckets.find(client);
+        if (it == buckets.end()) {
+            TokenBucket bucket;
+            bucket.tokens = burst;
+            bucket.lastRefill = now;
+            it = buckets.insert(make_pair(client, bucket)).first;
+        }
+        
+        TokenBucket& bucket = it->second;
+        double elapsed = chrono::duration<double>(now - bucket.lastRefill).count();
+        bucket.tokens = min(burst, bucket.tokens + elapsed * rate);
+        bucket.lastRefill = now;
+        if (bucket.tokens < 1.0) {
+            return false;
+        }
+        bucket.tokens -= 1.0;
+        return true;
+    }
+    
+    // Mutations from scorers run first, ahead of any queued reads, but under
+    // their own per-pass budget so a flood of POSTs cannot starve reads.
+    // Reads then share a fixed budget per loop pass in round-robin order, so
+    // a burst of dashboard GETs delays the next pass by a bounded amount.
+    // Reads that already waited past the latency target are shed with 503.
+    void processQueuedRequests() {
+        int mutationBudget = MAX_MUTATIONS_PER_CYCLE;
+        bool progress = true;
+        while (progress) {
+            progress = false;
+            for (auto& conn : connections) {
+                if (!conn.canRun()) continue;
+                
+                PendingRequest& next = conn.pending.front();
+                if (!next.rejection.empty()) {
+                    runNextRequest(conn);
+                    progress = true;
+                } else if (next.mutation && mutationBudget > 0) {
+                    mutationBudget--;
+                    runNextRequest(conn);
+                    progress = true;
+                }
+            }
+        }
+        
+        int budget = MAX_READS_PER_CYCLE;
+        progress = true;
+        while (budget > 0 && progress) {
+            progress = false;
+            auto now = chrono::steady_clock::now();
+            for (auto& conn : connections) {
+                if (!conn.canRun()) continue;
+                
+                PendingRequest& next = conn.pending.front();
+                if (next.mutation && next.rejection.empty()) {
+                    // Out of mutation budget; it runs first on the next pass
+                    continue;
+                }
+                if (!next.mutation && next.rejection.empty()) {
+                    if (now - next.queuedAt > chrono::milliseconds(READ_LATENCY_TARGET_MS)) {
+                        next.rejection = "503 Service Unavailable";
+                    } else {
+                        budget--;
+                    }
+                }
+                runNextRequest(conn);
+                progress = true;
+                if (budget == 0) break;
+            }
         }
         
-        closesocket(clientSocket);
+        for (auto& conn : connections) {
+            if (conn.closeWhenDrained && conn.pending.empty()) {
+                conn.closeAfterWrite = true;
+            }
+        }
     }
     
-    string processRequest(const string& request) {
+    void runNextRequest(Connection& conn) {
+        PendingRequest request = conn.pending.front();
+        conn.pending.pop_front();
+        if (request.countedAsRead) {
+            conn.queuedReads--;
+        }
+        if (request.countedAsMutation) {
+            conn.queuedMutations--;
+        }
+        
+        bool keepAlive = true;
+        if (request.rejection.empty()) {
+            conn.outBuffer += processRequest(request.raw, keepAlive, conn);
+        } else {
+            keepAlive = request.rejection.find("413") != 0;
+            conn.outBuffer += rejectionResponse(request.rejection, keepAlive);
+        }
+        
+        if (!keepAlive) {
+            conn.pending.clear();
+            conn.queuedReads = 0;
+            conn.queuedMutations = 0;
+            conn.closeAfterWrite = true;
+        }
+    }
+    
+    string rejectionResponse(const string& status, bool keepAlive) {
+        JsonBuilder error;
+        string extraHeaders;
+        if (status.find("413") == 0) {
+            error.addString("error", "Request too large");
+        } else if (status.find("429") == 0) {
+            error.addString("error", "Rate limit exceeded");
+            extraHeaders = "Retry-After: " + to_string(RETRY_AFTER_SECONDS) + "\r\n";
+        } else {
+            error.addString("error", "Server busy");
+            extraHeaders = "Retry-After: " + to_string(RETRY_AFTER_SECONDS) + "\r\n";
+        }
+        return buildResponse(status, error.build(), keepAlive, "application/json", extraHeaders);
+    }
+    
+    void flushOutput(Connection& conn) {
+        while (conn.hasPendingOutput()) {
+            int sent = send(conn.socket, conn.outBuffer.data() + conn.outOffset,
+                            (int)(conn.outBuffer.size() - conn.outOffset), 0);
+            if (sent > 0) {
+                // Any progress counts as activity, so a long export that
+                // drains its own buffer is not mistaken for an idle client
+                conn.outOffset += sent;
+                conn.lastActive = time(nullptr);
+                continue;
+            }
+            if (sent == SOCKET_ERROR && wouldBlock()) {
+                return;
+            }
+            conn.outBuffer.clear();
+            conn.outOffset = 0;
+            conn.exportCursor.reset();
+            conn.closeAfterWrite = true;
+            return;
+        }
+        conn.outBuffer.clear();
+        conn.outOffset = 0;
+    }
+    
+    void closeFinishedConnections(time_t now) {
+        auto finished = [&](const Connection& conn) {
+            bool done = conn.closeAfterWrite && !conn.hasPendingOutput() && !conn.exportCursor;
+            // lastActive moves on every read and every successful send, so a
+            // client that stops reading a response (or an export) times out
+            // too; erasing the connection drops its output and export cursor
+            bool idle = difftime(now, conn.lastActive) > IDLE_TIMEOUT_SECONDS 
+                && (conn.pending.empty() || conn.hasPendingOutput());
+            if (done || idle) {
+                if (idle && conn.hasPendingOutput()) {
+                    // Reset rather than leave the unsent output queued in the kernel
+                    linger abort;
+                    abort.l_onoff = 1;
+                    abort.l_linger = 0;
+                    setsockopt(conn.socket, SOL_SOCKET, SO_LINGER, (char*)&abort, sizeof(abort));
+                }
+                closesocket(conn.socket);
+                return true;
+            }
+            return false;
+        };
+        connections.erase(remove_if(connections.begin(), connections.end(), finished),
+                          connections.end());
+    }
+    
+    // Split one complete request (headers plus Content-Length body) off the
+    // front of the buffer. Returns false while the request is still partial.
+    static bool extractRequest(string& buffer, string& request) {
+        size_t headerEnd = buffer.find("\r\n\r\n");
+        if (headerEnd == string::npos) {
+            return false;
+        }
+        
+        size_t contentLength = 0;
+        string header = buffer.substr(0, headerEnd);
+        transform(header.begin(), header.end(), header.begin(), ::tolower);
+        size_t pos = header.find("\r\ncontent-length:");
+        if (pos != string::npos) {
+            contentLength = strtoul(header.c_str() + pos + 17, nullptr, 10);
+        }
+        
+        size_t total = headerEnd + 4 + contentLength;
+        if (buffer.size() < total) {
+            return false;
+        }
+        
+        request = buffer.substr(0, total);
+        buffer.erase(0, total);
+        return true;
+    }
+    
+    string buildHeaders(const string& status, bool keepAlive, const string& contentType,
+                        const string& extraHeaders) {
+        string response = "HTTP/1.1 " + status + "\r\n";
+        response += "Access-Control-Allow-Origin: *\r\n";
+        response += "Access-Control-Allow-Methods: GET, HEAD, POST, PUT, DELETE, OPTIONS\r\n";
+        response += "Access-Control-Allow-Headers: Content-Type\r\n";
+        response += "Content-Type: " + contentType + "\r\n";
+        response += extraHeaders;
+        response += keepAlive ? "Connection: keep-alive\r\n" : "Connection: close\r\n";
+        response += "\r\n";
+        return response;
+    }
+    
+    string buildResponse(const string& status, const string& body, bool keepAlive,
+                         const string& contentType = "application/json",
+                         const string& extraHeaders = "") {
+        string contentLength = "Content-Length: " + to_string(body.size()) + "\r\n";
+        return buildHeaders(status, keepAlive, contentType, contentLength + extraHeaders) + body;
+    }
+    
+    // Value of name in the path's query string, or "" if absent
+    static string queryParameter(const string& path, const string& name) {
+        size_t start = path.find('?');
+        if (start == string::npos) {
+            return "";
+        }
+        stringstream ss(path.substr(start + 1));
+        string pair;
+        while (getline(ss, pair, '&')) {
+            size_t equals = pair.find('=');
+            if (pair.substr(0, equals) == name) {
+                return equals == string::npos ? "" : pair.substr(equals + 1);
+            }
+        }
+        return "";
+    }
+    
+    string processRequest(const string& request, bool& keepAlive, Connection& conn) {
         istringstream iss(request);
         string method, path, version;
         iss >> method >> path >> version;
         
-        // Parse headers
+        // Parse headers; names are case-insensitive, so they are stored lower-cased
         string line;
         map<string, string> headers;
+        getline(iss, line); // rest of the request line
         while (getline(iss, line) && line != "\r") {
-            if (line.find(": ") != string::npos) {
-                size_t pos = line.find(": ");
+            size_t pos = line.find(':');
+            if (pos != string::npos) {
                 string key = line.substr(0, pos);
-                string value = line.substr(pos + 2);
+                transform(key.begin(), key.end(), key.begin(), ::tolower);
+                size_t start = line.find_first_not_of(" \t", pos + 1);
+                string value = start == string::npos ? "" : line.substr(start);
                 if (!value.empty() && value.back() == '\r') {
                     value.pop_back();
                 }
@@ -608,6 +1636,13 @@ private:
             }
         }
         
+        // HTTP/1.1 defaults to persistent connections, HTTP/1.0 does not
+        string connection = headers["connection"];
+        transform(connection.begin(), connection.end(), connection.begin(), ::tolower);
+        keepAlive = (version == "HTTP/1.1") ? connection != "close" : connection == "keep-alive";
+        
+        string encoding = negotiateEncoding(headers["accept-encoding"]);
+        
         // Get body
         string body;
         while (getline(iss, line)) {
@@ -615,46 +1650,311 @@ private:
         }
         
         // Handle CORS
-        string response = "HTTP/1.1 200 OK\r\n";
-        response += "Access-Control-Allow-Origin: *\r\n";
-        response += "Access-Control-Allow-Methods: GET, POST, PUT, DELETE, OPTIONS\r\n";
-        response += "Access-Control-Allow-Headers: Content-Type\r\n";
-        response += "Content-Type: application/json\r\n";
-        response += "\r\n";
-        
         if (method == "OPTIONS") {
-            return response;
+            return buildResponse("200 OK", "", keepAlive);
         }
         
         try {
-            if (method == "GET") {
-                response += handleGET(path);
+            if ((method == "GET" || method == "HEAD") && path.find("/api/") != 0) {
+                return headersOnlyFor(method, serveStaticAsset(path, headers, encoding, keepAlive));
+            } else if (method == "GET" && path.substr(0, path.find('?')) == "/api/export") {
+                return startExport(conn, path, keepAlive);
+            } else if (method == "GET") {
+                return serveApiGET(path, encoding, keepAlive);
+            } else if (method == "POST" && path == "/api/query" && !queryEngine.requestColumns(playerList)) {
+                // Columns are built on first use; ask the client to come back
+                return rejectionResponse("503 Service Unavailable", keepAlive);
             } else if (method == "POST") {
-                response += handlePOST(path, body);
+                string result = handlePOST(path, body);
+                if (isMutation(method, path)) dataVersion++;
+                return buildResponse("200 OK", result, keepAlive);
             } else if (method == "DELETE") {
-                response += handleDELETE(path);
+                string result = handleDELETE(path);
+                dataVersion++;
+                return buildResponse("200 OK", result, keepAlive);
             } else {
-                response = "HTTP/1.1 405 Method Not Allowed\r\n";
-                response += "Access-Control-Allow-Origin: *\r\n";
-                response += "Access-Control-Allow-Methods: GET, POST, PUT, DELETE, OPTIONS\r\n";
-                response += "Access-Control-Allow-Headers: Content-Type\r\n";
-                response += "Content-Type: application/json\r\n\r\n";
-                response += "{\"error\": \"Method not allowed\"}";
+                return buildResponse("405 Method Not Allowed", "{\"error\": \"Method not allowed\"}", keepAlive);
             }
         } catch (const exception& e) {
             JsonBuilder error;
             error.addString("error", e.what());
-            response = "HTTP/1.1 500 Internal Server Error\r\n";
-            response += "Access-Control-Allow-Origin: *\r\n";
-            response += "Access-Control-Allow-Methods: GET, POST, PUT, DELETE, OPTIONS\r\n";
-            response += "Access-Control-Allow-Headers: Content-Type\r\n";
-            response += "Content-Type: application/json\r\n\r\n";
-            response += error.build();
+            return buildResponse("500 Internal Server Error", error.build(), keepAlive);
+        }
+    }
+    
+    // 64-bit FNV-1a hash of the content, used as a strong ETag
+    static string computeETag(const string& content) {
+        unsigned long long hash = 14695981039346656037ULL;
+        for (unsigned char c : content) {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+        stringstream ss;
+        ss << "\"" << hex << setw(16) << setfill('0') << hash << "\"";
+        return ss.str();
+    }
+    
+    // Read the frontend once at startup. Scripts and styles are cached
+    // forever; index.html is revalidated and links to them by content hash,
+    // so a changed asset gets a new URL.
+    void loadStaticAssets() {
+        for (const auto& file : STATIC_FILES) {
+            ifstream in(file.first, ios::binary);
+            if (!in.is_open()) {
+                cout << "Warning: Could not load frontend file " << file.first << endl;
+                continue;
+            }
+            stringstream content;
+            content << in.rdbuf();
+            
+            StaticAsset asset;
+            asset.contentType = file.second;
+            asset.body = content.str();
+            asset.etag = computeETag(asset.body);
+            asset.cacheControl = "public, max-age=31536000, immutable";
+            asset.gzipBody = precompress(asset.body);
+            staticAssets["/" + file.first] = asset;
         }
         
+        auto index = staticAssets.find("/" + INDEX_FILE);
+        if (index == staticAssets.end()) {
+            return;
+        }
+        
+        StaticAsset& page = index->second;
+        for (const auto& pair : staticAssets) {
+            if (pair.first == index->first) continue;
+            string fileName = pair.first.substr(1);
+            string versioned = fileName + "?v=" + pair.second.etag.substr(1, 16);
+            const string attrs[] = {"src=\"", "href=\""};
+            for (const string& attr : attrs) {
+                size_t pos = page.body.find(attr + fileName + "\"");
+                if (pos != string::npos) {
+                    page.body.replace(pos + attr.size(), fileName.size(), versioned);
+                }
+            }
+        }
+        page.etag = computeETag(page.body);
+        page.cacheControl = "no-cache";
+        page.gzipBody = precompress(page.body);
+        staticAssets["/"] = page;
+    }
+    
+    static string precompress(const string& body) {
+        string compressed = Compressor::gzip(body, MAX_COMPRESSION_EFFORT);
+        return compressed.size() < body.size() ? compressed : "";
+    }
+    
+    // Pick gzip or deflate from an Accept-Encoding header, honouring q=0
+    static string negotiateEncoding(string acceptEncoding) {
+        transform(acceptEncoding.begin(), acceptEncoding.end(), acceptEncoding.begin(), ::tolower);
+        bool gzip = false, deflate = false;
+        stringstream ss(acceptEncoding);
+        string token;
+        while (getline(ss, token, ',')) {
+            token.erase(remove(token.begin(), token.end(), ' '), token.end());
+            string name = token.substr(0, token.find(';'));
+            bool refused = token.find(";q=0") != string::npos 
+                && token.find_first_of("123456789", token.find(";q=0")) == string::npos;
+            if (refused) continue;
+            if (name == "gzip") gzip = true;
+            if (name == "deflate") deflate = true;
+        }
+        return gzip ? "gzip" : (deflate ? "deflate" : "");
+    }
+    
+    // Large API responses are compressed once per data version and encoding
+    string serveApiGET(const string& path, const string& encoding, bool keepAlive) {
+        string varyHeader = "Vary: Accept-Encoding\r\n";
+        if (encoding.empty()) {
+            return buildResponse("200 OK", handleGET(path), keepAlive, "application/json", varyHeader);
+        }
+        
+        // Compressed bodies are cached per route until the data next changes
+        if (responseCacheVersion != dataVersion) {
+            responseCache.clear();
+            responseCacheVersion = dataVersion;
+        }
+        string route = cacheRoute(path);
+        string key = route + "|" + encoding;
+        auto cached = responseCache.find(key);
+        if (!route.empty() && cached != responseCache.end()) {
+            return buildResponse("200 OK", cached->second.body, keepAlive, "application/json", 
+                                 cached->second.headers);
+        }
+        
+        CachedResponse entry;
+        entry.body = handleGET(path);
+        entry.headers = varyHeader;
+        if (entry.body.size() >= COMPRESSION_THRESHOLD) {
+            string compressed = Compressor::compress(entry.body, encoding, compressionEffort);
+            if (compressed.size() < entry.body.size()) {
+                entry.body = compressed;
+                entry.headers += "Content-Encoding: " + encoding + "\r\n";
+            }
+        }
+        if (!route.empty() && entry.headers != varyHeader) {
+            if (responseCache.size() >= MAX_CACHED_RESPONSES) responseCache.clear();
+            responseCache[key] = entry;
+        }
+        return buildResponse("200 OK", entry.body, keepAlive, "application/json", entry.headers);
+    }
+    
+    string serveStaticAsset(const string& path, map<string, string>& headers, 
+                            const string& encoding, bool keepAlive) {
+        string file = path.substr(0, path.find('?'));
+        auto it = staticAssets.find(file);
+        if (it == staticAssets.end()) {
+            JsonBuilder error;
+            error.addString("error", "Not found");
+            return buildResponse("404 Not Found", error.build(), keepAlive);
+        }
+        
+        const StaticAsset& asset = it->second;
+        bool gzipped = encoding == "gzip" && !asset.gzipBody.empty();
+        
+        // Each encoding is a separate representation and needs its own strong ETag
+        string etag = gzipped ? asset.etag.substr(0, asset.etag.size() - 1) + "-gz\"" : asset.etag;
+        string cacheHeaders = "ETag: " + etag + "\r\n";
+        cacheHeaders += "Cache-Control: " + asset.cacheControl + "\r\n";
+        cacheHeaders += "Vary: Accept-Encoding\r\n";
+        if (gzipped) {
+            cacheHeaders += "Content-Encoding: gzip\r\n";
+        }
+        
+        if (etagMatches(headers["if-none-match"], etag)) {
+            return buildResponse("304 Not Modified", "", keepAlive, asset.contentType, cacheHeaders);
+        }
+        return buildResponse("200 OK", gzipped ? asset.gzipBody : asset.body, keepAlive, 
+                             asset.contentType, cacheHeaders);
+    }
+    
+    // If-None-Match holds "*" or a comma-separated list of entity tags
+    static bool etagMatches(const string& ifNoneMatch, const string& etag) {
+        stringstream ss(ifNoneMatch);
+        string candidate;
+        while (getline(ss, candidate, ',')) {
+            size_t start = candidate.find_first_not_of(" \t");
+            size_t end = candidate.find_last_not_of(" \t");
+            if (start == string::npos) continue;
+            candidate = candidate.substr(start, end - start + 1);
+            if (candidate == "*" || candidate == etag || candidate == "W/" + etag) {
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    // A HEAD response is the GET response with the body left off
+    static string headersOnlyFor(const string& method, const string& response) {
+        if (method != "HEAD") return response;
+        return response.substr(0, response.find("\r\n\r\n") + 4);
+    }
+    
+    static bool isMutation(const string& method, const string& path) {
+        return method == "DELETE" || (method == "POST" && path != "/api/query");
+    }
+    
+    string startExport(Connection& conn, const string& path, bool keepAlive) {
+        string format = queryParameter(path, "format");
+        if (format.empty()) {
+            format = "ndjson";
+        }
+        if (format != "ndjson" && format != "csv") {
+            throw runtime_error("Unsupported export format: " + format);
+        }
+        
+        auto cursor = make_shared<ExportCursor>();
+        cursor->format = format;
+        cursor->entryIndex = 0;
+        cursor->matchIndex = 0;
+        for (Player* current = playerList.getHead(); current != nullptr; current = current->getNext()) {
+            ExportEntry entry;
+            entry.player = current;
+            entry.id = current->getId();
+            entry.name = current->getName();
+            entry.role = current->getRole();
+            entry.matchCount = current->getTotalMatches();
+            cursor->entries.push_back(entry);
+        }
+        conn.exportCursor = cursor;
+        
+        string contentType = format == "csv" ? "text/csv" : "application/x-ndjson";
+        string extraHeaders = "Transfer-Encoding: chunked\r\n";
+        extraHeaders += "Content-Disposition: attachment; filename=\"cricket_export." + format + "\"\r\n";
+        string response = buildHeaders("200 OK", keepAlive, contentType, extraHeaders);
+        if (format == "csv") {
+            string header = "playerId,player,role,date,score,opponent,venue,isHome\n";
+            stringstream chunk;
+            chunk << hex << header.size() << "\r\n" << header << "\r\n";
+            response += chunk.str();
+        }
         return response;
     }
     
+    // Append up to EXPORT_CHUNK_SIZE bytes of rows as one HTTP chunk, and the
+    // terminating chunk once every row has been written
+    void writeExportChunk(Connection& conn) {
+        ExportCursor& cursor = *conn.exportCursor;
+        string rows;
+        while (rows.size() < EXPORT_CHUNK_SIZE && cursor.entryIndex < cursor.entries.size()) {
+            ExportEntry& entry = cursor.entries[cursor.entryIndex];
+            if (cursor.matchIndex >= entry.matchCount) {
+                cursor.entryIndex++;
+                cursor.matchIndex = 0;
+                continue;
+            }
+            
+            const MatchStats& match = entry.player != nullptr 
+                ? entry.player->getStats()[cursor.matchIndex] 
+                : entry.detachedRows[cursor.matchIndex];
+            cursor.matchIndex++;
+            
+            if (cursor.format == "csv") {
+                rows += to_string(entry.id) + "," + csvField(entry.name) + "," + csvField(entry.role) + ","
+                    + csvField(match.date) + "," + to_string(match.score) + "," + csvField(match.opponent) + ","
+                    + csvField(match.venue) + "," + (match.isHome ? "true" : "false") + "\n";
+            } else {
+                JsonBuilder row;
+                row.addNumber("playerId", entry.id);
+                row.addString("player", entry.name);
+                row.addString("role", entry.role);
+                row.addString("date", match.date);
+                row.addNumber("score", match.score);
+                row.addString("opponent", match.opponent);
+                row.addString("venue", match.venue);
+                row.addBool("isHome", match.isHome);
+                rows += row.build() + "\n";
+            }
+        }
+        
+        if (!rows.empty()) {
+            stringstream size;
+            size << hex << rows.size();
+            conn.outBuffer += size.str() + "\r\n" + rows + "\r\n";
+        }
+        if (cursor.entryIndex >= cursor.entries.size()) {
+            conn.outBuffer += "0\r\n\r\n";
+            conn.exportCursor.reset();
+        }
+    }
+    
+    // Keep a deleted player's rows for exports that have not reached them yet
+    void detachFromExports(int playerId) {
+        for (auto& conn : connections) {
+            if (!conn.exportCursor) continue;
+            ExportCursor& cursor = *conn.exportCursor;
+            for (size_t i = cursor.entryIndex; i < cursor.entries.size(); i++) {
+                ExportEntry& entry = cursor.entries[i];
+                if (entry.id == playerId && entry.player != nullptr) {
+                    const auto& stats = entry.player->getStats();
+                    entry.detachedRows.assign(stats.begin(), stats.begin() + entry.matchCount);
+                    entry.player = nullptr;
+                }
+            }
+        }
+    }
+    
     string handleGET(const string& path) {
         if (path == "/api/players") {
             return getAllPlayers();
@@ -664,6 +1964,8 @@ private:
             return getPlayersInForm();
         } else if (path == "/api/stats") {
             return getTeamStats();
+        } else if (isSimilarPlayersPath(path)) {
+            return getSimilarPlayers(path);
         } else {
             throw runtime_error("Endpoint not found");
         }
@@ -674,6 +1976,8 @@ private:
             return addPlayer(body);
         } else if (path == "/api/matches") {
             return addMatch(body);
+        } else if (path == "/api/query") {
+            return queryEngine.execute(body);
         } else {
             throw runtime_error("Endpoint not found");
         }
@@ -757,6 +2061,79 @@ private:
         return result;
     }
     
+    static bool isSimilarPlayersPath(const string& path) {
+        string route = path.substr(0, path.find('?'));
+        const string prefix = "/api/players/";
+        const string suffix = "/similar";
+        return route.size() > prefix.size() + suffix.size() && route.find(prefix) == 0
+            && route.compare(route.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+    
+    static void parseSimilarPlayersPath(const string& path, int& playerId, int& k) {
+        string route = path.substr(0, path.find('?'));
+        k = DEFAULT_SIMILAR_PLAYERS;
+        try {
+            playerId = stoi(route.substr(13, route.size() - 13 - 8));
+            string kStr = queryParameter(path, "k");
+            if (!kStr.empty()) {
+                k = stoi(kStr);
+            }
+        } catch (const exception& e) {
+            throw runtime_error("Invalid player ID or k");
+        }
+        k = max(1, min(MAX_SIMILAR_PLAYERS, k));
+    }
+    
+    // Cache key for a GET path: the fixed endpoints as they are, similar
+    // players as id plus k so extra query parameters cannot add entries.
+    // "" for anything that should not be cached.
+    static string cacheRoute(const string& path) {
+        if (path == "/api/players" || path == "/api/players/top" || path == "/api/players/form" 
+            || path == "/api/stats") {
+            return path;
+        }
+        if (isSimilarPlayersPath(path)) {
+            int playerId, k;
+            try {
+                parseSimilarPlayersPath(path, playerId, k);
+            } catch (const exception& e) {
+                return "";
+            }
+            return "/api/players/" + to_string(playerId) + "/similar?k=" + to_string(k);
+        }
+        return "";
+    }
+    
+    // GET /api/players/{id}/similar?k=N
+    string getSimilarPlayers(const string& path) {
+        int playerId, k;
+        parseSimilarPlayersPath(path, playerId, k);
+        
+        if (!similarityIndex.contains(playerId)) {
+            throw runtime_error("Player with ID " + to_string(playerId) + " not found.");
+        }
+        similarityIndex.refreshTrackedOpponents();
+        
+        string result = "[";
+        bool first = true;
+        for (const auto& match : similarityIndex.nearest(playerId, k)) {
+            const Player* similar = match.first;
+            if (!first) result += ",";
+            
+            JsonBuilder player;
+            player.addNumber("id", similar->getId());
+            player.addString("name", similar->getName());
+            player.addString("role", similar->getRole());
+            player.addDouble("average", similar->getAverageScore());
+            player.addDouble("distance", match.second);
+            
+            result += player.build();
+            first = false;
+        }
+        result += "]";
+        return result;
+    }
+    
     string getTeamStats() {
         JsonBuilder stats;
         stats.addNumber("totalPlayers", playerList.getSize());
@@ -785,7 +2162,8 @@ private:
             throw runtime_error("Name and role are required");
         }
         
-        playerList.addPlayer(name, role);
+        Player* player = playerList.addPlayer(name, role);
+        similarityIndex.upsert(*player);
         playerList.saveToFile();
         
         JsonBuilder response;
@@ -804,12 +2182,20 @@ private:
         if (playerName.empty() || date.empty() || scoreStr.empty()) {
             throw runtime_error("Player name, date, and score are required");
         }
+        if (MatchQueryEngine::parseDate(date) == 0) {
+            throw runtime_error("Date must be in YYYY-MM-DD form");
+        }
         
         int score = stoi(scoreStr);
         bool isHome = (isHomeStr == "true");
         
         MatchStats match(date, score, opponent, venue, isHome);
         playerList.addPlayerStats(playerName, match);
+        Player* player = playerList.findPlayer(playerName);
+        if (player != nullptr) {
+            similarityIndex.upsert(*player);
+            queryEngine.addMatch(*player, match);
+        }
         playerList.saveToFile();
         
         JsonBuilder response;
@@ -818,6 +2204,9 @@ private:
     }
 
     string deletePlayer(int playerId) {
+        detachFromExports(playerId);
+        similarityIndex.remove(playerId);
+        queryEngine.removePlayer(playerId);
         if (playerList.deletePlayer(playerId)) {
             playerList.saveToFile();
             JsonBuilder response;
@@ -827,26 +2216,25 @@ private:
             throw runtime_error("Player with ID " + to_string(playerId) + " not found.");
         }
     }
-    
-    string extractValue(const string& json, const string& key) {
-        string searchKey = "\"" + key + "\":\"";
-        size_t pos = json.find(searchKey);
-        if (pos == string::npos) {
-            return "";
-        }
-        
-        pos += searchKey.length();
-        size_t endPos = json.find("\"", pos);
-        if (endPos == string::npos) {
-            return "";
-        }
-        
-        return json.substr(pos, endPos - pos);
-    }
 };
 
-int main() {
+int main(int argc, char* argv[]) {
+    int port = 8080;
+    int backlog = DEFAULT_LISTEN_BACKLOG;
+    size_t historyBudget = DEFAULT_HISTORY_BUDGET;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg.find("--port=") == 0) {
+            port = stoi(arg.substr(7));
+        } else if (arg.find("--backlog=") == 0) {
+            backlog = stoi(arg.substr(10));
+        } else if (arg.find("--history-budget-mb=") == 0) {
+            historyBudget = stoul(arg.substr(20)) * 1024 * 1024;
+        }
+    }
+    
     CricketAPI api;
-    api.start(8080);
+    api.setHistoryBudget(historyBudget);
+    api.start(port, backlog);
     return 0;
 } 
\ No newline at end of file
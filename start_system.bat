@@ -15,7 +15,7 @@ timeout /t 3 /nobreak > nul
 echo.
 echo Step 3: Opening Frontend...
 echo.
-start "" "index.html"
+start "" "http://localhost:8080/"
 
 echo.
 echo Step 4: Opening API Test Page...
@@ -28,7 +28,7 @@ echo System Started Successfully!
 echo ========================================
 echo.
 echo Backend: http://localhost:8080
-echo Frontend: index.html (opened in browser)
+echo Frontend: http://localhost:8080/ (opened in browser)
 echo API Test: test_api.html (opened in browser)
 echo.
 echo Press any key to exit this launcher...